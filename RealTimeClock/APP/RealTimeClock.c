@@ -11,243 +11,808 @@
  *******************************************************************************/
 #include "../HAL/Keypad/keypad_driver.h"
 #include "../HAL/LCD/LCD.h"
+#include "../HAL/LCD/LCD_big.h"
 #include "../HAL/SevenSegment/seven segment.h"
+#include "../LIB/cpu_load.h"
+#include "../LIB/latency.h"
+#include "../LIB/profiler.h"
+#include "../LIB/rtc_format.h"
 #include "../LIB/std_macros.h"
+#include "../MCAL/ADC/ADC.h"
+#include "../MCAL/SPI/SPI.h"
+#include "../MCAL/TWI/TWI.h"
 #include "../MCAL/Timer/timer.h"
+#include "../MCAL/UART/UART.h"
+#include "../MCAL/WDT/WDT.h"
+#include "calib.h"
+#include "clock.h"
+#include "diag.h"
+#include "eventlog.h"
+#include "rtcsync.h"
+#include "storage.h"
+#include "telemetry.h"
+#include "tz.h"
 #include <avr/interrupt.h>
 #include <avr/io.h>
+#include <util/atomic.h>
 
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
-#define F_CPU 8000000UL
-#include <util/delay.h>
+#if BOARD_HAS_SEVSEG
+#define RESET_HINT "Press 0 to Reset"
+#define ADJUST_HINT "+/- set  = next"
+#else
+#define RESET_HINT "0=Reset" // the time takes the rest of the row
+#define ADJUST_HINT "+/- =>"
+#endif
+
+/* System tick on the timer0 compare (clk/64, 8us per count). On the seven
+ * segment board each tick also lights the next digit, so its period is the
+ * display step; otherwise 250 x 8us = 2ms */
+#if BOARD_HAS_SEVSEG
+#define TICK_OCR SEVSEG_STEP_OCR
+#else
+#define TICK_OCR 249
+#endif
+#define TICK_US ((TICK_OCR + 1) * 8UL)
+
+/* How long "Invalid! Retry" stays up before the field is asked again */
+#define INVALID_SHOW_MS 900
+
+#if BOARD_HAS_SEVSEG
+/* Fields not being adjusted are shown at this fraction of the brightness */
+#define ADJUST_DIM_SHIFT 2
+#define DISPLAY_NO_FIELD 0xff
+
+/* HH.MM.SS takes digits 0-5; any further digits are left blank */
+#define DISPLAY_TIME_DIGITS 6
+#else
+/* Home time on the run screen: HH:MM in big digits across both rows, the
+ * seconds (and AM/PM above them) in the last two columns */
+#define BIG_HOURS_COLUMN 1
+#define BIG_COLON_COLUMN (BIG_HOURS_COLUMN + 2 * LCD_BIG_WIDTH)
+#define BIG_MINUTES_COLUMN (BIG_COLON_COLUMN + 1)
+#define BIG_SMALL_COLUMN 15
+#endif
+
+#if BOARD_HAS_LIGHT_SENSOR
+/* Light reading per brightness level: dark is level 0, full light the top */
+#define LIGHT_PER_LEVEL ((ADC_FULL_SCALE + 1UL) / SEVSEG_LEVELS)
+#endif
+
+/* 'A' held with '0': leave a configuration started from the run screen */
+#define CANCEL_COMBO (keypad_u16key_mask('A') | keypad_u16key_mask('0'))
+
+/* User interface states, walked by ui_task() one key at a time */
+#define UI_MODE 0
+#define UI_AMPM 1
+#define UI_HOURS 2
+#define UI_MINUTES 3
+#define UI_SECONDS 4
+#define UI_INVALID 5
+#define UI_RUN 6  // clock running, run screen
+#define UI_DIAG 7 // clock running, diagnostics page
+#define UI_ADJUST 8 // clock running, '+'/'-' nudge one field
 
 /*******************************************************************************
  *                              Global Variables                               *
  *******************************************************************************/
-volatile unsigned char seconds_counter = 0;
-unsigned char minutes_counter = 0, hours_counter = 0;
-
-unsigned char value, first_digit, second_digit;
-
-unsigned char mode = 24;
-unsigned char am_pm = 0;        // 0 = AM, 1 = PM
-unsigned char ampm_changed = 0; // NEW ? to prevent flicker
+unsigned char value, first_digit;
+
+unsigned char am_pm = 0;     // 0 = AM, 1 = PM
+unsigned char shown_pm = 0;  // AM/PM currently written on the LCD
+
+unsigned char ui_state = UI_MODE;
+unsigned char retry_state;   // field asked again after UI_INVALID
+unsigned int invalid_since;  // tick when "Invalid! Retry" was shown
+unsigned char entry_mode;    // format chosen in UI_MODE
+clock_time_t entry;          // time being typed in
+unsigned char diag_page;
+unsigned char adjust_field;   // CLOCK_FIELD_* nudged in UI_ADJUST
+unsigned char can_cancel = 0; // configuration entered from the run screen
+
+/* Milliseconds since boot, advanced by the timer0 tick */
+volatile unsigned int ms_ticks = 0;
+
+/* CPU cycles from the start of main() until the first digit is lit */
+volatile unsigned int boot_first_digit_cycles = 0;
+
+/* ADC inputs: the light sensor if fitted, the bandgap for the supply */
+#if BOARD_HAS_LIGHT_SENSOR
+const unsigned char adc_inputs[] = {LIGHT_SENSOR_ADC_CHANNEL,
+                                    ADC_CHANNEL_BANDGAP};
+#else
+const unsigned char adc_inputs[] = {ADC_CHANNEL_BANDGAP};
+#endif
+
+#if BOARD_HAS_SEVSEG
+unsigned char display_level = SEVSEG_LEVELS - 1; // '+'/'-' on the run screen
+unsigned char display_revision = 0; // clock revision in the last frame
+#if BOARD_HAS_LIGHT_SENSOR
+signed char display_trim = 0; // '+'/'-' offset from the light sensor level
+#endif
+#else
+unsigned char shown_seconds = 0xff; // last second drawn on the LCD
+char big_shown[4]; // "HHMM" in big digits, ' ' where not drawn
+#endif
 
 /*******************************************************************************
  *                             Functions Definitions                           *
  *******************************************************************************/
 
+#if BOARD_HAS_SEVSEG
 /**
- * @brief  Get a two-digit number from the user via Keypad.
- * @param  result Pointer to store the result.
+ * @brief  Draw the time into the next display frame as HH.MM.SS. The frame
+ *         is only redrawn when the clock changed (the second tick, a set,
+ *         a nudge or a mode change); the refresh keeps showing the segment
+ *         bytes of the last frame.
+ * @param  None
  * @return None
  */
-void get_two_digits(unsigned char *result) {
-  do {
-    first_digit = keypad_u8check_press();
-  } while (first_digit == NOTPRESSED);
-  LCD_vSend_char(first_digit);
-  _delay_ms(200);
-
-  do {
-    second_digit = keypad_u8check_press();
-  } while (second_digit == NOTPRESSED);
-  LCD_vSend_char(second_digit);
-  _delay_ms(200);
-
-  *result = (second_digit - '0') + 10 * (first_digit - '0');
+void display_render(void) {
+  clock_time_t now;
+  clock_date_t date;
+  unsigned char bcd;
+  unsigned char field[3];
+  unsigned char i;
+  unsigned char revision = clock_u8revision();
+
+  if (revision == display_revision || !seven_seg_u8back_free()) {
+    return; // nothing new, or the last frame is not shown yet
+  }
+  display_revision = revision;
+  tz_vget_local(TZ_HOME, &now, &date);
+  field[0] = now.seconds;
+  field[1] = now.minutes;
+  field[2] = clock_u8display_hours(now.hours);
+  for (i = 0; i < 3; i++) {
+    bcd = rtc_format_u8bcd(field[i]);
+    seven_seg_vset_digit(2 * i, bcd & 0x0F);
+    seven_seg_vset_digit(2 * i + 1, bcd >> 4);
+  }
+  for (i = DISPLAY_TIME_DIGITS; i < SEVSEG_DIGITS; i++) {
+    seven_seg_vset_segments(i, 0);
+  }
+  seven_seg_vset_colon(1);
+  seven_seg_vpublish();
 }
 
 /**
- * @brief  Main function of the application.
- * @param  None
- * @return return int (standard for main, though never returns in embedded)
+ * @brief  Show one time field at the display level and dim the others.
+ * @param  field CLOCK_FIELD_* to highlight, DISPLAY_NO_FIELD for none.
+ * @return None
  */
-int main(void) {
-  keypad_vInit();
-  LCD_vInit();
-  seven_seg_vinit('B');
-  DDRC |= 0b00111111;
-
-  timer2_overflow_init_interrupt();
-  sei();
+void display_highlight(unsigned char field) {
+  unsigned char digit;
+  unsigned char digit_field;
+
+  for (digit = 0; digit < SEVSEG_DIGITS; digit++) {
+    // digits 0-1 seconds, 2-3 minutes, 4-5 hours, the rest no field
+    digit_field = (digit < DISPLAY_TIME_DIGITS)
+                      ? CLOCK_FIELD_SECONDS - digit / 2
+                      : DISPLAY_NO_FIELD;
+    if (field == DISPLAY_NO_FIELD || field == digit_field) {
+      seven_seg_vset_brightness(digit, display_level);
+    } else {
+      seven_seg_vset_brightness(digit, display_level >> ADJUST_DIM_SHIFT);
+    }
+  }
+}
 
-  while (1) {
-    // ===================== CHOOSE MODE =====================
-    LCD_clearscreen();
-    LCD_vSend_string("1-12h   2-24h");
-    LCD_movecursor(2, 1);
-    LCD_vSend_string("Choose mode");
+#if BOARD_HAS_LIGHT_SENSOR
+/**
+ * @brief  Set the display level from the ambient light plus the '+'/'-'
+ *         trim. Called once per second, so the level does not flicker.
+ * @param  None
+ * @return None
+ */
+void display_follow_light(void) {
+  unsigned int light = ADC_u16get_filtered(LIGHT_SENSOR_ADC_CHANNEL);
+  signed char level;
 
-    while (1) {
-      value = keypad_u8check_press();
-      if (value == '1') {
-        mode = 12;
-        break;
-      }
-      if (value == '2') {
-        mode = 24;
-        break;
-      }
-    }
+  if (light == ADC_NO_DATA) {
+    return; // keep the current level until the first sample
+  }
+  level = (signed char)(light / LIGHT_PER_LEVEL) + display_trim;
+  if (level < 1) {
+    level = 1;
+  } else if (level > SEVSEG_LEVELS - 1) {
+    level = SEVSEG_LEVELS - 1;
+  }
+  if ((unsigned char)level != display_level) {
+    display_level = level;
+    display_highlight(ui_state == UI_ADJUST ? adjust_field : DISPLAY_NO_FIELD);
+  }
+}
+#endif
+#else
+/**
+ * @brief  Whether the run screen shows the home time in big digits.
+ * @param  None
+ * @return 1 on the run screen without a world zone, 0 otherwise.
+ */
+unsigned char show_big_time(void) {
+  return ui_state == UI_RUN && tz_u8get_world() == TZ_HOME;
+}
 
-    while (keypad_u8check_press() != NOTPRESSED)
-      ;
-
-    // ================== ASK AM/PM (if 12h) ==================
-    if (mode == 12) {
-      LCD_clearscreen();
-      LCD_vSend_string("1=AM   2=PM");
-
-      while (1) {
-        value = keypad_u8check_press();
-        if (value == '1') {
-          am_pm = 0;
-          break;
-        }
-        if (value == '2') {
-          am_pm = 1;
-          break;
-        }
-      }
-      while (keypad_u8check_press() != NOTPRESSED)
-        ;
+/**
+ * @brief  Show the running time on the LCD (boards without seven segment).
+ *         In big digits only the digits that changed are rewritten, so a
+ *         plain second costs a cursor move and two characters.
+ * @param  None
+ * @return None
+ */
+void show_time_on_lcd(void) {
+  static const char big_columns[4] = {
+      BIG_HOURS_COLUMN, BIG_HOURS_COLUMN + LCD_BIG_WIDTH, BIG_MINUTES_COLUMN,
+      BIG_MINUTES_COLUMN + LCD_BIG_WIDTH};
+  clock_time_t now;
+  clock_date_t date;
+  char text[RTC_FORMAT_TIME_SIZE];
+  unsigned char i;
+
+  tz_vget_local(TZ_HOME, &now, &date);
+  rtc_format_vtime(clock_u8display_hours(now.hours), now.minutes, now.seconds,
+                   text);
+  if (!show_big_time()) {
+    LCD_movecursor(2, 9);
+    LCD_vSend_string(text);
+    return;
+  }
+  for (i = 0; i < 4; i++) {
+    char digit = text[i + i / 2]; // skip the ':' of "HH:MM"
+    if (digit != big_shown[i]) {
+      big_shown[i] = digit;
+      LCD_vbig_digit(big_columns[i], digit - '0');
     }
+  }
+  LCD_movecursor(2, BIG_SMALL_COLUMN);
+  LCD_vSend_string(&text[6]);
+}
+#endif
 
-    // ================= SET HOURS =================
-    LCD_clearscreen();
-    LCD_vSend_string("Set Hours:");
-    LCD_movecursor(2, 1);
-
-    unsigned char hrs;
-    while (1) {
-      get_two_digits(&hrs);
+/**
+ * @brief  Read the millisecond tick.
+ * @param  None
+ * @return Milliseconds since boot (wraps every ~65s).
+ */
+unsigned int ticks_u16now(void) {
+  unsigned int now;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { now = ms_ticks; }
+  return now;
+}
 
-      if (mode == 24 && hrs <= 23) {
-        hours_counter = hrs;
-        break;
-      }
+/**
+ * @brief  Write the time of the selected world zone on the first row, as
+ *         "NYC 14:05:09" or "NYC 02:05:09 PM".
+ * @param  None
+ * @return None
+ */
+void show_world_time(void) {
+  clock_time_t now;
+  clock_date_t date;
+  char text[RTC_FORMAT_TIME12_SIZE];
+  unsigned char zone = tz_u8get_world();
+
+  tz_vzone_name(zone, text);
+  LCD_movecursor(1, 1);
+  LCD_vSend_string(text);
+  LCD_vSend_char(' ');
+  tz_vget_local(zone, &now, &date);
+  if (clock_u8get_mode() == CLOCK_MODE_12H) {
+    rtc_format_vtime12(now.hours, now.minutes, now.seconds, text);
+  } else {
+    rtc_format_vtime(now.hours, now.minutes, now.seconds, text);
+  }
+  LCD_vSend_string(text);
+}
 
-      if (mode == 12 && hrs >= 1 && hrs <= 12) {
-        hours_counter = hrs;
-        break;
-      }
+/**
+ * @brief  Write the local date after the name of the date field being
+ *         adjusted.
+ * @param  None
+ * @return None
+ */
+void show_adjust_date(void) {
+  clock_time_t now;
+  clock_date_t date;
+  char text[RTC_FORMAT_DATE_SIZE];
+
+  tz_vget_local(TZ_HOME, &now, &date);
+  rtc_format_vdate(2000 + date.year, date.month, date.day, text);
+  LCD_movecursor(1, 7);
+  LCD_vSend_string(text);
+}
 
-      LCD_clearscreen();
-      LCD_vSend_string("Invalid! Retry");
-      _delay_ms(900);
-      LCD_clearscreen();
-      LCD_vSend_string("Set Hours:");
-      LCD_movecursor(2, 1);
+/**
+ * @brief  Write the run screen (format and AM/PM, or the world zone time,
+ *         and the reset hint). Without the seven segment the home time
+ *         takes the whole screen in big digits.
+ * @param  None
+ * @return None
+ */
+void show_run_screen(void) {
+  LCD_clearscreen();
+#if !BOARD_HAS_SEVSEG
+  shown_seconds = 0xff;
+  if (show_big_time()) {
+    big_shown[0] = big_shown[1] = big_shown[2] = big_shown[3] = ' ';
+    LCD_vbig_colon(BIG_COLON_COLUMN);
+    if (clock_u8get_mode() == CLOCK_MODE_12H) {
+      LCD_movecursor(1, BIG_SMALL_COLUMN);
+      LCD_vSend_string(shown_pm ? "PM" : "AM");
     }
+    return; // no room for the reset hint; '0' still resets
+  }
+#endif
+  if (tz_u8get_world() != TZ_HOME) {
+    show_world_time();
+  } else if (clock_u8get_mode() == CLOCK_MODE_12H) {
+    LCD_vSend_string(shown_pm ? "Mode: PM" : "Mode: AM");
+  } else
+    LCD_vSend_string("24h Mode");
+
+  LCD_movecursor(2, 1);
+  LCD_vSend_string(RESET_HINT);
+}
 
-    // ================= SET MINUTES =================
-    LCD_clearscreen();
+/**
+ * @brief  Switch the user interface state and draw its screen.
+ * @param  state UI_* state to enter.
+ * @return None
+ */
+void ui_enter(unsigned char state) {
+  clock_time_t now;
+  clock_date_t date;
+
+  ui_state = state;
+  first_digit = NOTPRESSED;
+  LCD_clearscreen();
+  switch (state) {
+  case UI_MODE:
+    LCD_vSend_string("1-12h   2-24h");
+    LCD_movecursor(2, 1);
+    LCD_vSend_string("Choose mode");
+    break;
+  case UI_AMPM:
+    LCD_vSend_string("1=AM   2=PM");
+    break;
+  case UI_HOURS:
+    LCD_vSend_string("Set Hours:");
+    LCD_movecursor(2, 1);
+    break;
+  case UI_MINUTES:
     LCD_vSend_string("Set Minutes:");
     LCD_movecursor(2, 1);
-    get_two_digits(&minutes_counter);
-
-    // ================= SET SECONDS =================
-    LCD_clearscreen();
+    break;
+  case UI_SECONDS:
     LCD_vSend_string("Set Seconds:");
     LCD_movecursor(2, 1);
-    get_two_digits(&seconds_counter);
+    break;
+  case UI_INVALID:
+    LCD_vSend_string("Invalid! Retry");
+    invalid_since = ticks_u16now();
+    break;
+  case UI_RUN:
+    tz_vget_local(TZ_HOME, &now, &date);
+    shown_pm = (now.hours >= 12);
+    show_run_screen();
+#if BOARD_HAS_SEVSEG
+    display_highlight(DISPLAY_NO_FIELD);
+#endif
+    break;
+  case UI_DIAG:
+    diag_vshow(diag_page);
+    break;
+  case UI_ADJUST:
+    if (adjust_field == CLOCK_FIELD_HOURS) {
+      LCD_vSend_string("Adjust Hours");
+    } else if (adjust_field == CLOCK_FIELD_MINUTES) {
+      LCD_vSend_string("Adjust Minutes");
+    } else if (adjust_field == CLOCK_FIELD_SECONDS) {
+      LCD_vSend_string("Adjust Seconds");
+    } else {
+      if (adjust_field == CLOCK_FIELD_DAY) {
+        LCD_vSend_string("Day");
+      } else if (adjust_field == CLOCK_FIELD_MONTH) {
+        LCD_vSend_string("Month");
+      } else {
+        LCD_vSend_string("Year");
+      }
+      show_adjust_date();
+    }
+    LCD_movecursor(2, 1);
+    LCD_vSend_string(ADJUST_HINT);
+#if BOARD_HAS_SEVSEG
+    display_highlight(adjust_field);
+#endif
+#if !BOARD_HAS_SEVSEG
+    shown_seconds = 0xff;
+#endif
+    break;
+  default:
+    break;
+  }
+}
 
-    // ===================== Final LCD =====================
-    LCD_clearscreen();
-    if (mode == 12) {
-      LCD_vSend_string(am_pm ? "Mode: PM" : "Mode: AM");
-    } else
-      LCD_vSend_string("24h Mode");
+/**
+ * @brief  Take a complete two-digit field and move to the next state.
+ * @param  None (the field is in value)
+ * @return None
+ */
+void ui_field_done(void) {
+  switch (ui_state) {
+  case UI_HOURS:
+    if (entry_mode == CLOCK_MODE_24H && value <= 23) {
+      entry.hours = value;
+    } else if (entry_mode == CLOCK_MODE_12H && value >= 1 && value <= 12) {
+      entry.hours = (value % 12) + (am_pm ? 12 : 0);
+    } else {
+      retry_state = UI_HOURS;
+      ui_enter(UI_INVALID);
+      return;
+    }
+    ui_enter(UI_MINUTES);
+    break;
+  case UI_MINUTES:
+    if (value > 59) {
+      retry_state = UI_MINUTES;
+      ui_enter(UI_INVALID);
+      return;
+    }
+    entry.minutes = value;
+    ui_enter(UI_SECONDS);
+    break;
+  case UI_SECONDS:
+    if (value > 59) {
+      retry_state = UI_SECONDS;
+      ui_enter(UI_INVALID);
+      return;
+    }
+    entry.seconds = value;
+    clock_vSet_mode(entry_mode);
+    tz_vset_local(&entry); // entered in TZ_HOME, kept in UTC
+    can_cancel = 0;
+    storage_vrequest_save();
+    eventlog_vadd(EVENTLOG_TIME_SET, EVENTLOG_SET_ENTRY);
+#if BOARD_HAS_EXT_RTC
+    rtcsync_vtime_set();
+#endif
+    ui_enter(UI_RUN);
+    break;
+  default:
+    break;
+  }
+}
 
-    LCD_movecursor(2, 1);
-    LCD_vSend_string("Press 0 to Reset");
-
-    ampm_changed = 0;
-
-    // ==================== RUN CLOCK =====================
-    while (1) {
-      // Reset?
-      value = keypad_u8check_press();
-      if (value == '0')
-        break;
-
-      // Multiplexing
-      PORTC = 0b111110;
-      seven_seg_write('B', seconds_counter % 10);
-      _delay_ms(2);
-
-      PORTC = 0b111101;
-      seven_seg_write('B', seconds_counter / 10);
-      _delay_ms(2);
-
-      PORTC = 0b111011;
-      seven_seg_write('B', minutes_counter % 10);
-      _delay_ms(2);
-
-      PORTC = 0b110111;
-      seven_seg_write('B', minutes_counter / 10);
-      _delay_ms(2);
-
-      PORTC = 0b101111;
-      seven_seg_write('B', hours_counter % 10);
-      _delay_ms(2);
-
-      PORTC = 0b011111;
-      seven_seg_write('B', hours_counter / 10);
-      _delay_ms(2);
-
-      // 12H MODE HANDLING
-      if (mode == 12) {
-        // Rollover
-        if (hours_counter > 12)
-          hours_counter = 1;
-
-        // Perfect AM/PM toggle at EXACT 12:00:00
-        if (hours_counter == 12 && minutes_counter == 0 &&
-            seconds_counter == 0) {
-          if (!ampm_changed) // only once!
-          {
-            am_pm ^= 1;
-            ampm_changed = 1;
-
-            LCD_clearscreen();
-            LCD_vSend_string(am_pm ? "Mode: PM" : "Mode: AM");
-            LCD_movecursor(2, 1);
-            LCD_vSend_string("Press 0 to Reset");
-          }
-        } else {
-          ampm_changed = 0;
-        }
-      }
+/**
+ * @brief  Handle at most one key event; never waits for the user.
+ * @param  now_ms Current millisecond tick.
+ * @return None
+ */
+void ui_task(unsigned int now_ms) {
+  unsigned char event = KEYPAD_EVENT_PRESS;
+  char key = keypad_u8get_key(now_ms, &event);
+
+  if (key != NOTPRESSED && event == KEYPAD_EVENT_PRESS) {
+    LATENCY_STAMP(LATENCY_UI, LATENCY_SRC_KEYPAD);
+  }
+  if (ui_state == UI_ADJUST && (key == '+' || key == '-')) {
+    // every press, long press and repeat is one step
+    clock_vnudge(adjust_field, (key == '+') ? 1 : -1);
+    if (adjust_field >= CLOCK_FIELD_DAY) {
+      show_adjust_date();
+    }
+#if !BOARD_HAS_SEVSEG
+    shown_seconds = 0xff; // redraw at once
+#endif
+    return;
+  }
+  if (event != KEYPAD_EVENT_PRESS) {
+    key = NOTPRESSED; // holding a key only repeats '+'/'-' in UI_ADJUST
+  }
 
-    } // while display
+  if (key == '0' && ui_state < UI_RUN && can_cancel &&
+      keypad_u16held() == CANCEL_COMBO) {
+    can_cancel = 0;
+    ui_enter(UI_RUN); // the clock kept running, nothing was changed
+    return;
+  }
 
-  } // while 1
+  switch (ui_state) {
+  case UI_MODE:
+    if (key == '1') {
+      entry_mode = CLOCK_MODE_12H;
+      ui_enter(UI_AMPM);
+    } else if (key == '2') {
+      entry_mode = CLOCK_MODE_24H;
+      ui_enter(UI_HOURS);
+    }
+    break;
+  case UI_AMPM:
+    if (key == '1' || key == '2') {
+      am_pm = (key == '2');
+      ui_enter(UI_HOURS);
+    }
+    break;
+  case UI_HOURS:
+  case UI_MINUTES:
+  case UI_SECONDS:
+    if (key >= '0' && key <= '9') {
+      LCD_vSend_char(key);
+      if (first_digit == NOTPRESSED) {
+        first_digit = key;
+      } else {
+        value = (key - '0') + 10 * (first_digit - '0');
+        first_digit = NOTPRESSED;
+        ui_field_done();
+      }
+    }
+    break;
+  case UI_INVALID:
+    if ((unsigned int)(now_ms - invalid_since) >= INVALID_SHOW_MS) {
+      ui_enter(retry_state);
+    }
+    break;
+  case UI_RUN:
+    if (key == '0') {
+      can_cancel = 1;
+      ui_enter(UI_MODE);
+    } else if (key == '*') {
+      diag_page = 0;
+      ui_enter(UI_DIAG);
+    } else if (key == '=') {
+      adjust_field = CLOCK_FIELD_HOURS;
+      ui_enter(UI_ADJUST);
+    } else if (key == '/') {
+      tz_vnext_world(); // the seven segment keeps TZ_HOME
+      storage_vrequest_save();
+      show_run_screen();
+    }
+#if BOARD_HAS_LIGHT_SENSOR
+    // '+'/'-' trim the level the light sensor picks
+    else if (key == '+' && display_trim < SEVSEG_LEVELS - 1) {
+      display_trim++;
+      display_follow_light();
+    } else if (key == '-' && display_trim > 1 - SEVSEG_LEVELS) {
+      display_trim--;
+      display_follow_light();
+    }
+#elif BOARD_HAS_SEVSEG
+    else if (key == '+' && display_level < SEVSEG_LEVELS - 1) {
+      display_level++;
+      display_highlight(DISPLAY_NO_FIELD);
+    } else if (key == '-' && display_level > 1) {
+      display_level--;
+      display_highlight(DISPLAY_NO_FIELD);
+    }
+#endif
+    break;
+  case UI_DIAG:
+    if (key == '*' && diag_page + 1 < DIAG_PAGES) {
+      diag_page++;
+      ui_enter(UI_DIAG);
+#if LATENCY_TRACE_ENABLED
+      if (diag_page == DIAG_PAGE_LATENCY) {
+        diag_vdump_latency();
+      }
+#endif
+#if PROFILER_ENABLED
+      if (diag_page == DIAG_PAGE_PROFILER) {
+        diag_vdump_profiler();
+      }
+#endif
+    }
+#if BOARD_HAS_PPS_INPUT
+    else if (key == '=' && diag_page == DIAG_PAGE_CALIB) {
+      calib_vstart();
+      diag_vshow(diag_page);
+    }
+#endif
+#if BOARD_HAS_UART
+    else if (key == '=' && diag_page == DIAG_PAGE_EVENTS) {
+      eventlog_vstart_dump();
+      diag_vshow(diag_page);
+    }
+#endif
+    else if (key != NOTPRESSED) {
+      ui_enter(UI_RUN);
+    }
+    break;
+  case UI_ADJUST:
+    if (key == '=') {
+      if (adjust_field < CLOCK_FIELD_YEAR) {
+        adjust_field++;
+        ui_enter(UI_ADJUST);
+      } else {
+        storage_vrequest_save();
+        eventlog_vadd(EVENTLOG_TIME_SET, EVENTLOG_SET_ADJUST);
+#if BOARD_HAS_EXT_RTC
+        rtcsync_vtime_set();
+#endif
+        ui_enter(UI_RUN);
+      }
+    }
+    break;
+  default:
+    ui_enter(UI_MODE);
+    break;
+  }
 }
 
 /**
- * @brief  Timer2 Overflow Interrupt Service Routine.
- * @param  TIMER2_OVF_vect Interrupt vector.
+ * @brief  Keep the run screen (or the diagnostics page) up to date while the
+ *         clock runs.
+ * @param  None
  * @return None
  */
-ISR(TIMER2_OVF_vect) {
-  seconds_counter++;
+void run_task(void) {
+  static unsigned long shown_uptime = 0;
+  clock_time_t now;
+  clock_date_t date;
+
+  if (clock_u32uptime() != shown_uptime) {
+    shown_uptime = clock_u32uptime();
+#if BOARD_HAS_LIGHT_SENSOR
+    display_follow_light();
+#endif
+    if (ui_state == UI_DIAG) {
+      diag_vshow(diag_page); // the load figures change once per second
+    } else if (ui_state == UI_RUN && tz_u8get_world() != TZ_HOME) {
+      show_world_time();
+    }
+  }
+  if (ui_state == UI_DIAG) {
+    return;
+  }
+  if (ui_state != UI_RUN && ui_state != UI_ADJUST) {
+    return;
+  }
+  tz_vget_local(TZ_HOME, &now, &date);
+#if !BOARD_HAS_SEVSEG
+  if (now.seconds != shown_seconds) {
+    shown_seconds = now.seconds;
+    show_time_on_lcd();
+  }
+#endif
+  if (ui_state == UI_ADJUST) {
+    return; // the first row names the field, not AM/PM
+  }
 
-  if (seconds_counter >= 60) {
-    seconds_counter = 0;
-    minutes_counter++;
+  // 12H MODE HANDLING: AM/PM follows the 24h time, redraw once on change
+  if (clock_u8get_mode() == CLOCK_MODE_12H && (now.hours >= 12) != shown_pm &&
+      tz_u8get_world() == TZ_HOME) {
+    shown_pm = (now.hours >= 12);
+    show_run_screen();
   }
+}
 
-  if (minutes_counter >= 60) {
-    minutes_counter = 0;
-    hours_counter++;
+/**
+ * @brief  Main function of the application.
+ * @param  None
+ * @return return int (standard for main, though never returns in embedded)
+ */
+int main(void) {
+  unsigned char reset_cause;
+  unsigned char kept;    // time kept in RAM across the reset
+  unsigned char resumed; // time kept, restored or loaded from the chip
+  unsigned int now_ms;
+
+  timer1_free_running_init();
+#if PROFILER_ENABLED
+  profiler_vInit();
+#endif
+  reset_cause = WDT_u8reset_cause();
+  WDT_vInit();
+  diag_vrecord_reset(reset_cause);
+  keypad_vInit();
+  // Warm reset: the time in .noinit is valid the moment the display starts
+  kept = clock_u8Init(!(reset_cause & WDT_RESET_POWER_ON));
+  resumed = kept;
+#if BOARD_HAS_SEVSEG
+  // Light the display before the (slow) LCD power-on sequence; the timer0
+  // interrupt keeps multiplexing while the LCD initializes.
+  seven_seg_vinit();
+  display_render();
+  seven_seg_u8refresh_step();
+#if SEVSEG_SPI
+  SPI_vflush(); // latch the first digit before it is timed
+#endif
+  boot_first_digit_cycles = timer1_u16read();
+#endif
+  timer0_CTC_period_init_interrupt(TICK_OCR);
+  ADC_vInit(adc_inputs, sizeof(adc_inputs)); // triggered by the timer0 tick
+  storage_vInit();
+  calib_vInit();
+  tz_vInit();
+  if (!resumed) {
+    resumed = clock_u8restore();
+  }
+#if BOARD_HAS_EXT_RTC
+  TWI_vInit();
+  rtcsync_vInit(); // the chip is read while the LCD starts up
+#endif
+#if BOARD_HAS_UART
+  UART_vInit();
+#endif
+  sei();
+  LCD_vInit();
+#if !BOARD_HAS_SEVSEG
+  LCD_vbig_init();
+#endif
+#if BOARD_HAS_EXT_RTC
+  // the chip kept running through the power loss: newer than the EEPROM
+  if (!kept && rtcsync_u8load()) {
+    resumed = 1;
+  }
+#endif
+  eventlog_vInit();
+  eventlog_vadd(EVENTLOG_RESET, reset_cause); // stamped with the restored time
+#if TELEMETRY_ENABLED
+  telemetry_vInit(reset_cause);
+#endif
+
+  ui_enter(resumed ? UI_RUN : UI_MODE);
+
+  // Dispatch loop: every task returns quickly, so the watchdog is fed at
+  // least every few milliseconds and only a real hang lets it expire.
+  while (1) {
+    now_ms = ticks_u16now();
+    cpu_load_vpass(now_ms);
+    WDT_vfeed();
+
+    PROFILE_BEGIN(PROF_TASK_UI);
+    ui_task(now_ms);
+    PROFILE_END(PROF_TASK_UI);
+
+    PROFILE_BEGIN(PROF_TASK_RUN);
+    run_task();
+#if BOARD_HAS_SEVSEG
+    display_render();
+#endif
+    PROFILE_END(PROF_TASK_RUN);
+
+    if (ui_state >= UI_RUN) {
+      PROFILE_BEGIN(PROF_TASK_STORAGE);
+      storage_vtask();
+      PROFILE_END(PROF_TASK_STORAGE);
+    }
+#if BOARD_HAS_PPS_INPUT
+    calib_vtask();
+#endif
+#if BOARD_HAS_EXT_RTC
+    if (ui_state == UI_RUN || ui_state == UI_DIAG) {
+      rtcsync_vtask(); // not while a time is typed in or nudged
+    }
+#endif
+    eventlog_vtask();
+#if TELEMETRY_ENABLED
+    telemetry_vtask(now_ms);
+#endif
   }
+}
 
-  if (mode == 24) {
-    if (hours_counter >= 24)
-      hours_counter = 0;
+/**
+ * @brief  Timer0 Compare Match Interrupt Service Routine (system tick).
+ * @param  TIMER0_COMP_vect Interrupt vector.
+ * @return None
+ */
+ISR(TIMER0_COMP_vect) {
+  static unsigned int tick_us = 0; // sub-millisecond remainder
+  CPU_LOAD_ISR_BEGIN();
+  LATENCY_TICK();
+#if BOARD_HAS_SEVSEG
+  // two compares per display step (lit and blank), one tick per step
+  if (seven_seg_u8refresh_step())
+#endif
+  {
+    ms_ticks += TICK_US / 1000;
+    tick_us += TICK_US % 1000;
+    if (tick_us >= 1000) {
+      tick_us -= 1000;
+      ms_ticks++;
+    }
   }
-}
\ No newline at end of file
+  CPU_LOAD_ISR_END(CPU_LOAD_ISR_TIMER0);
+}
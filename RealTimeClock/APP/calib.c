@@ -0,0 +1,255 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: calib.c
+ * Description: Source file for the crystal drift calibration against 1PPS
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "calib.h"
+#include "../LIB/cpu_load.h"
+#include "../LIB/std_macros.h"
+#include "../MCAL/EEPROM/EEPROM.h"
+#include "../MCAL/Timer/timer.h"
+#include "eventlog.h"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Seed of the record checksum, so an erased EEPROM does not pass as valid */
+#define CALIB_RECORD_SEED 0xCA1B
+
+/* Timer1 counts per 1/256 of CLOCK_TRIM_SCALE * 10^6 counts:
+ * trim = (C - P) * SCALE * 10^6 / P = (C - P) * 256 / (P / 62500) */
+#define CALIB_SPAN_DIVISOR (CLOCK_TRIM_SCALE * 1000000UL / 256)
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+typedef struct {
+  signed int trim;
+  unsigned int crc;
+} calib_record_t;
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+#if BOARD_HAS_PPS_INPUT
+static volatile unsigned char calib_state = CALIB_IDLE;
+static unsigned char calib_save_pending = 0;
+static unsigned char calib_logged = 1; // the result is in the event log
+static calib_record_t calib_record;
+
+/* Written by the ISRs while calibrating */
+static volatile unsigned int calib_overflows; // high word of the timestamps
+static volatile unsigned long calib_pps_first, calib_pps_last;
+static volatile unsigned int calib_pps_count; // edges since the start
+static volatile unsigned long calib_xtal_first, calib_xtal_last;
+static volatile unsigned int calib_xtal_count; // crystal seconds
+#endif
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Checksum of a trim record.
+ * @param  record Pointer to the record.
+ * @return CRC-CCITT of the trim.
+ */
+static unsigned int calib_u16record_crc(const calib_record_t *record) {
+  unsigned int crc = CALIB_RECORD_SEED;
+  unsigned int trim = (unsigned int)record->trim;
+  crc = _crc_ccitt_update(crc, (unsigned char)trim);
+  crc = _crc_ccitt_update(crc, (unsigned char)(trim >> 8));
+  return crc;
+}
+
+/**
+ * @brief  Load the trim saved in EEPROM and apply it to the clock.
+ * @param  None
+ * @return None
+ */
+void calib_vInit(void) {
+  calib_record_t record;
+
+  EEPROM_vread_block(CALIB_EEPROM_ADDRESS, (unsigned char *)&record,
+                     sizeof(record));
+  if (record.crc == calib_u16record_crc(&record) &&
+      record.trim <= CALIB_TRIM_MAX && record.trim >= -CALIB_TRIM_MAX) {
+    clock_vset_trim(record.trim);
+  }
+}
+
+#if BOARD_HAS_PPS_INPUT
+/**
+ * @brief  Extend a Timer1 count to 32 bits (ISR context). An overflow that
+ *         is pending but not yet counted belongs to counts that wrapped.
+ * @param  count Timer1 count taken in the ISR.
+ * @return The 32-bit timestamp.
+ */
+static unsigned long calib_u32stamp(unsigned int count) {
+  unsigned int high = calib_overflows;
+  if ((TIFR & (1 << TOV1)) && count < 0x8000) {
+    high++;
+  }
+  return ((unsigned long)high << 16) | count;
+}
+
+/**
+ * @brief  Start measuring the crystal against the 1PPS input.
+ * @param  None
+ * @return None
+ */
+void calib_vstart(void) {
+  CLR_BIT(PPS_DDR, PPS_PIN); // input, driven by the reference
+  CLR_BIT(PPS_PORT, PPS_PIN);
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    calib_overflows = 0;
+    calib_pps_count = 0;
+    calib_xtal_count = 0;
+    calib_state = CALIB_RUNNING;
+    timer1_capture_init_interrupt();
+  }
+  calib_logged = 0;
+}
+
+/**
+ * @brief  Timestamp a crystal second. Called from the Timer2 ISR.
+ * @param  None
+ * @return None
+ */
+void calib_vcrystal_tick(void) {
+  unsigned long stamp;
+
+  if (calib_state != CALIB_RUNNING) {
+    return;
+  }
+  stamp = calib_u32stamp(TCNT1);
+  // the crystal span starts at the first tick after the first edge
+  if (calib_pps_count == 0) {
+    return;
+  }
+  if (calib_xtal_count == 0) {
+    calib_xtal_first = stamp;
+  } else if (calib_xtal_count == CALIB_WINDOW_S) {
+    calib_xtal_last = stamp;
+  }
+  calib_xtal_count++;
+  if (calib_xtal_count > CALIB_WINDOW_S &&
+      calib_pps_count > CALIB_WINDOW_S) {
+    timer1_capture_stop();
+    calib_state = CALIB_MEASURED;
+  } else if (calib_xtal_count > CALIB_WINDOW_S + CALIB_TIMEOUT_S) {
+    timer1_capture_stop(); // the reference stopped or never started
+    calib_state = CALIB_FAILED;
+  }
+}
+
+/**
+ * @brief  Turn a finished measurement into the trim and save it. Called
+ *         from the run loop; never waits for the EEPROM.
+ * @param  None
+ * @return None
+ */
+void calib_vtask(void) {
+  unsigned long crystal, reference, error;
+  signed long trim;
+
+  if (calib_state == CALIB_MEASURED) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      crystal = calib_xtal_last - calib_xtal_first;
+      reference = calib_pps_last - calib_pps_first;
+    }
+    // the CPU clock error is in both spans and cancels in the ratio
+    error = (crystal > reference) ? crystal - reference : reference - crystal;
+    if (error > reference / 4096) { // > 244 ppm: not a crystal error
+      calib_state = CALIB_FAILED;
+      return;
+    }
+    trim = (signed long)error * 256 / (signed long)(reference /
+                                                    CALIB_SPAN_DIVISOR);
+    if (crystal < reference) {
+      trim = -trim; // crystal fast, drop seconds
+    }
+    if (trim > CALIB_TRIM_MAX || trim < -CALIB_TRIM_MAX) {
+      calib_state = CALIB_FAILED;
+      return;
+    }
+    clock_vset_trim((signed int)trim);
+    calib_record.trim = (signed int)trim;
+    calib_record.crc = calib_u16record_crc(&calib_record);
+    calib_save_pending = 1;
+    calib_state = CALIB_DONE;
+  }
+  if ((calib_state == CALIB_DONE || calib_state == CALIB_FAILED) &&
+      !calib_logged) {
+    eventlog_vadd(EVENTLOG_CALIB, calib_state);
+    calib_logged = 1;
+  }
+  if (calib_save_pending &&
+      EEPROM_u8write_block_async(CALIB_EEPROM_ADDRESS,
+                                 (const unsigned char *)&calib_record,
+                                 sizeof(calib_record))) {
+    calib_save_pending = 0;
+  }
+}
+
+/**
+ * @brief  Calibration state.
+ * @param  None
+ * @return CALIB_IDLE, CALIB_RUNNING, CALIB_MEASURED, CALIB_DONE or
+ *         CALIB_FAILED.
+ */
+unsigned char calib_u8state(void) { return calib_state; }
+
+/**
+ * @brief  Reference seconds measured so far.
+ * @param  None
+ * @return 0 to CALIB_WINDOW_S.
+ */
+unsigned int calib_u16progress(void) {
+  unsigned int count;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { count = calib_pps_count; }
+  if (count == 0) {
+    return 0;
+  }
+  return (count - 1 > CALIB_WINDOW_S) ? CALIB_WINDOW_S : count - 1;
+}
+
+/**
+ * @brief  Timer1 Input Capture Interrupt Service Routine (1PPS edge).
+ * @param  TIMER1_CAPT_vect Interrupt vector.
+ * @return None
+ */
+ISR(TIMER1_CAPT_vect) {
+  CPU_LOAD_ISR_BEGIN();
+  unsigned long stamp = calib_u32stamp(ICR1);
+  if (calib_pps_count == 0) {
+    calib_pps_first = stamp;
+  } else if (calib_pps_count == CALIB_WINDOW_S) {
+    calib_pps_last = stamp;
+  }
+  if (calib_pps_count <= CALIB_WINDOW_S) {
+    calib_pps_count++;
+  }
+  CPU_LOAD_ISR_END(CPU_LOAD_ISR_TIMER1);
+}
+
+/**
+ * @brief  Timer1 Overflow Interrupt Service Routine (timestamp high word).
+ * @param  TIMER1_OVF_vect Interrupt vector.
+ * @return None
+ */
+ISR(TIMER1_OVF_vect) {
+  CPU_LOAD_ISR_BEGIN();
+  calib_overflows++;
+  CPU_LOAD_ISR_END(CPU_LOAD_ISR_TIMER1);
+}
+#endif
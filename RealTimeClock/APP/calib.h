@@ -0,0 +1,102 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: calib.h
+ * Description: Header file for the crystal drift calibration against 1PPS
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef CALIB_H_
+#define CALIB_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "../LIB/board_pinmap.h"
+#include "clock.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Both the external 1PPS edges (ICP1) and the 32.768kHz crystal seconds (the
+ * Timer2 tick) are timestamped with Timer1, extended to 32 bits by its
+ * overflow interrupt. The ratio of the two periods over CALIB_WINDOW_S
+ * seconds gives the crystal error; the CPU clock, which only serves as the
+ * common ruler, drops out. The result becomes the clock trim and is kept in
+ * EEPROM.
+ */
+#ifndef CALIB_WINDOW_S
+#define CALIB_WINDOW_S 64
+#endif
+#if CALIB_WINDOW_S > 500
+#error "calib.h: the 32-bit Timer1 timestamps wrap after 536s"
+#endif
+
+/* Crystal seconds past the window without enough reference edges */
+#define CALIB_TIMEOUT_S 5
+
+/* Larger errors mean a wrong reference, not a crystal */
+#define CALIB_TRIM_MAX (200 * CLOCK_TRIM_SCALE)
+
+/* Trim record after the storage ring */
+#define CALIB_EEPROM_ADDRESS 0x100
+
+/* Calibration states */
+#define CALIB_IDLE 0
+#define CALIB_RUNNING 1
+#define CALIB_MEASURED 2 // both spans taken, trim not computed yet
+#define CALIB_DONE 3
+#define CALIB_FAILED 4
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Load the trim saved in EEPROM and apply it to the clock.
+ * @param  None
+ * @return None
+ */
+void calib_vInit(void);
+
+#if BOARD_HAS_PPS_INPUT
+/**
+ * @brief  Start measuring the crystal against the 1PPS input.
+ * @param  None
+ * @return None
+ */
+void calib_vstart(void);
+
+/**
+ * @brief  Timestamp a crystal second. Called from the Timer2 ISR.
+ * @param  None
+ * @return None
+ */
+void calib_vcrystal_tick(void);
+
+/**
+ * @brief  Turn a finished measurement into the trim and save it. Called
+ *         from the run loop; never waits for the EEPROM.
+ * @param  None
+ * @return None
+ */
+void calib_vtask(void);
+
+/**
+ * @brief  Calibration state.
+ * @param  None
+ * @return CALIB_IDLE, CALIB_RUNNING, CALIB_MEASURED, CALIB_DONE or
+ *         CALIB_FAILED.
+ */
+unsigned char calib_u8state(void);
+
+/**
+ * @brief  Reference seconds measured so far.
+ * @param  None
+ * @return 0 to CALIB_WINDOW_S.
+ */
+unsigned int calib_u16progress(void);
+#endif
+
+#endif /* CALIB_H_ */
@@ -0,0 +1,462 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: clock.c
+ * Description: Source file for the timekeeping core
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "clock.h"
+#include "../LIB/cpu_load.h"
+#include "../LIB/profiler.h"
+#include "../MCAL/Timer/timer.h"
+#include "calib.h"
+#include "storage.h"
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Seed of the .noinit checksum, so cleared RAM does not pass as valid */
+#define CLOCK_STATE_SEED 0x5AC3
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+/* Clock state kept in .noinit: not cleared by the startup code, so it
+ * survives watchdog, brown-out and external resets */
+typedef struct {
+  clock_time_t now;
+  clock_date_t date;
+  unsigned char mode;
+  unsigned int check;
+} clock_state_t;
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static volatile clock_state_t clock_state __attribute__((section(".noinit")));
+static volatile unsigned long clock_uptime = 0;
+static volatile unsigned char clock_revision = 0; // bumped on every change
+
+/* Days per month outside leap years */
+static const unsigned char clock_month_days[12] PROGMEM = {
+    31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+/* Crystal trim and its accumulated fraction of a second (in trim units) */
+static volatile signed int clock_trim = 0;
+static signed long clock_trim_phase = 0;
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Checksum of the clock state (callers keep interrupts off).
+ * @param  None
+ * @return CRC-CCITT of time, date and mode.
+ */
+static unsigned int clock_u16state_check(void) {
+  unsigned int crc = CLOCK_STATE_SEED;
+  crc = _crc_ccitt_update(crc, clock_state.now.hours);
+  crc = _crc_ccitt_update(crc, clock_state.now.minutes);
+  crc = _crc_ccitt_update(crc, clock_state.now.seconds);
+  crc = _crc_ccitt_update(crc, clock_state.date.year);
+  crc = _crc_ccitt_update(crc, clock_state.date.month);
+  crc = _crc_ccitt_update(crc, clock_state.date.day);
+  crc = _crc_ccitt_update(crc, clock_state.mode);
+  return crc;
+}
+
+/**
+ * @brief  Number of days in a month.
+ * @param  month 1-12.
+ * @param  year 0-99 for 2000-2099.
+ * @return 28-31.
+ */
+unsigned char clock_u8days_in_month(unsigned char month, unsigned char year) {
+  if (month == 2 && (year & 3) == 0) {
+    return 29; // every fourth year is a leap year from 2000 to 2099
+  }
+  return pgm_read_byte(&clock_month_days[month - 1]);
+}
+
+/**
+ * @brief  Number of a day counted from 2000-01-01 (day 0, a Saturday).
+ * @param  date Pointer to the date.
+ * @return 0 to 36524.
+ */
+unsigned int clock_u16day_number(const clock_date_t *date) {
+  unsigned int days = date->year * 365U + (date->year + 3) / 4 + date->day - 1;
+  unsigned char month;
+
+  for (month = 1; month < date->month; month++) {
+    days += clock_u8days_in_month(month, date->year);
+  }
+  return days;
+}
+
+/**
+ * @brief  Check that a date is a real calendar day.
+ * @param  date Pointer to the date.
+ * @return 1 if valid, 0 otherwise.
+ */
+static unsigned char clock_u8date_valid(const clock_date_t *date) {
+  return date->year <= 99 && date->month >= 1 && date->month <= 12 &&
+         date->day >= 1 &&
+         date->day <= clock_u8days_in_month(date->month, date->year);
+}
+
+/**
+ * @brief  Start the 1 Hz Timer2 tick that drives the clock. After a warm
+ *         reset the time kept in .noinit resumes if its checksum holds,
+ *         otherwise the clock starts at 2000-01-01 00:00:00 in 24h mode.
+ * @param  warm Non-zero if RAM survived the reset (not a power-on reset).
+ * @return 1 if the time kept across the reset was resumed, 0 otherwise.
+ */
+unsigned char clock_u8Init(unsigned char warm) {
+  unsigned char resumed = 0;
+
+  if (warm && clock_state.check == clock_u16state_check() &&
+      (clock_state.mode == CLOCK_MODE_12H ||
+       clock_state.mode == CLOCK_MODE_24H) &&
+      clock_state.now.hours <= 23 && clock_state.now.minutes <= 59 &&
+      clock_state.now.seconds <= 59 &&
+      clock_u8date_valid((const clock_date_t *)&clock_state.date)) {
+    resumed = 1;
+  } else {
+    clock_state.now.hours = 0;
+    clock_state.now.minutes = 0;
+    clock_state.now.seconds = 0;
+    clock_state.date.year = 0;
+    clock_state.date.month = 1;
+    clock_state.date.day = 1;
+    clock_state.mode = CLOCK_MODE_24H;
+    clock_state.check = clock_u16state_check();
+  }
+  clock_revision++;
+  timer2_overflow_init_interrupt();
+  return resumed;
+}
+
+/**
+ * @brief  Set the current time.
+ * @param  time Pointer to the new time (24h form).
+ * @return None
+ */
+void clock_vSet(const clock_time_t *time) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    clock_state.now.hours = time->hours;
+    clock_state.now.minutes = time->minutes;
+    clock_state.now.seconds = time->seconds;
+    clock_state.check = clock_u16state_check();
+    clock_revision++;
+  }
+}
+
+/**
+ * @brief  Set the current date.
+ * @param  date Pointer to the new date.
+ * @return None
+ */
+void clock_vSet_date(const clock_date_t *date) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    clock_state.date.year = date->year;
+    clock_state.date.month = date->month;
+    clock_state.date.day = date->day;
+    clock_state.check = clock_u16state_check();
+    clock_revision++;
+  }
+}
+
+/**
+ * @brief  Step one field of the running time or date up or down. The field
+ *         wraps around without carrying into the next one; a day past the
+ *         end of the month after a month or year step is cut to its end.
+ * @param  field CLOCK_FIELD_* to change.
+ * @param  delta Signed step, e.g. +1 or -1.
+ * @return None
+ */
+void clock_vnudge(unsigned char field, signed char delta) {
+  volatile unsigned char *value;
+  unsigned char first = 0; // lowest value of the field
+  unsigned char limit;     // number of values
+  unsigned char last_day;
+  signed int result;
+
+  switch (field) {
+  case CLOCK_FIELD_HOURS:
+    value = &clock_state.now.hours;
+    limit = 24;
+    break;
+  case CLOCK_FIELD_MINUTES:
+    value = &clock_state.now.minutes;
+    limit = 60;
+    break;
+  case CLOCK_FIELD_DAY:
+    value = &clock_state.date.day;
+    first = 1;
+    limit = clock_u8days_in_month(clock_state.date.month,
+                                  clock_state.date.year);
+    break;
+  case CLOCK_FIELD_MONTH:
+    value = &clock_state.date.month;
+    first = 1;
+    limit = 12;
+    break;
+  case CLOCK_FIELD_YEAR:
+    value = &clock_state.date.year;
+    limit = 100;
+    break;
+  default:
+    value = &clock_state.now.seconds;
+    limit = 60;
+    break;
+  }
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    result = (signed int)*value - first + delta;
+    while (result < 0) {
+      result += limit;
+    }
+    while (result >= limit) {
+      result -= limit;
+    }
+    *value = (unsigned char)result + first;
+    last_day = clock_u8days_in_month(clock_state.date.month,
+                                     clock_state.date.year);
+    if (clock_state.date.day > last_day) {
+      clock_state.date.day = last_day; // 31 March -> February, 29 Feb -> 2001
+    }
+    clock_state.check = clock_u16state_check();
+    clock_revision++;
+  }
+}
+
+/**
+ * @brief  Take a consistent snapshot of the current time.
+ * @param  time Pointer to store the time (24h form).
+ * @return None
+ */
+void clock_vGet(clock_time_t *time) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    time->hours = clock_state.now.hours;
+    time->minutes = clock_state.now.minutes;
+    time->seconds = clock_state.now.seconds;
+  }
+}
+
+/**
+ * @brief  Take a consistent snapshot of the current time and date.
+ * @param  time Pointer to store the time (24h form).
+ * @param  date Pointer to store the date.
+ * @return None
+ */
+void clock_vGet_date(clock_time_t *time, clock_date_t *date) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    time->hours = clock_state.now.hours;
+    time->minutes = clock_state.now.minutes;
+    time->seconds = clock_state.now.seconds;
+    date->year = clock_state.date.year;
+    date->month = clock_state.date.month;
+    date->day = clock_state.date.day;
+  }
+}
+
+/**
+ * @brief  Current UTC time as one number, for timestamps.
+ * @param  None
+ * @return Seconds since 2000-01-01 00:00:00 UTC.
+ */
+unsigned long clock_u32seconds(void) {
+  clock_time_t now;
+  clock_date_t date;
+
+  clock_vGet_date(&now, &date);
+  return clock_u16day_number(&date) * 86400UL + now.hours * 3600UL +
+         now.minutes * 60U + now.seconds;
+}
+
+/**
+ * @brief  Select the display format.
+ * @param  mode CLOCK_MODE_12H or CLOCK_MODE_24H.
+ * @return None
+ */
+void clock_vSet_mode(unsigned char mode) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    clock_state.mode = mode;
+    clock_state.check = clock_u16state_check();
+    clock_revision++;
+  }
+}
+
+/**
+ * @brief  Get the display format.
+ * @param  None
+ * @return CLOCK_MODE_12H or CLOCK_MODE_24H.
+ */
+unsigned char clock_u8get_mode(void) { return clock_state.mode; }
+
+/**
+ * @brief  Convert 24h hours to the hours shown in the current mode.
+ * @param  hours Hours in 24h form (0-23).
+ * @return 0-23 in 24h mode, 1-12 in 12h mode.
+ */
+unsigned char clock_u8display_hours(unsigned char hours) {
+  if (clock_state.mode == CLOCK_MODE_12H) {
+    if (hours > 12) {
+      hours -= 12;
+    } else if (hours == 0) {
+      hours = 12;
+    }
+  }
+  return hours;
+}
+
+/**
+ * @brief  Restore time and settings saved in EEPROM before the last reset.
+ * @param  None
+ * @return 1 if a valid saved state was restored, 0 otherwise.
+ */
+unsigned char clock_u8restore(void) {
+  storage_record_t record;
+  clock_time_t time;
+  clock_date_t date;
+
+  /* the last EEPROM record; the time is as old as the power-off period */
+  if (!storage_u8load(&record)) {
+    return 0;
+  }
+  if ((record.mode != CLOCK_MODE_12H && record.mode != CLOCK_MODE_24H) ||
+      record.hours > 23 || record.minutes > 59 || record.seconds > 59) {
+    return 0;
+  }
+  date.year = record.year;
+  date.month = record.month;
+  date.day = record.day;
+  if (!clock_u8date_valid(&date)) {
+    return 0;
+  }
+  time.hours = record.hours;
+  time.minutes = record.minutes;
+  time.seconds = record.seconds;
+  clock_vSet_mode(record.mode);
+  clock_vSet(&time);
+  clock_vSet_date(&date);
+  return 1;
+}
+
+/**
+ * @brief  Seconds counted by the 1 Hz tick since boot.
+ * @param  None
+ * @return The uptime in seconds.
+ */
+unsigned long clock_u32uptime(void) {
+  unsigned long uptime;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { uptime = clock_uptime; }
+  return uptime;
+}
+
+/**
+ * @brief  Change counter of the time and mode, so a caller can redraw only
+ *         when something changed.
+ * @param  None
+ * @return A value that differs from the last one after any tick, set, nudge
+ *         or mode change.
+ */
+unsigned char clock_u8revision(void) { return clock_revision; }
+
+/**
+ * @brief  Set the crystal trim applied by the 1 Hz tick.
+ * @param  trim Correction in 1/CLOCK_TRIM_SCALE ppm, positive when the
+ *         crystal runs slow.
+ * @return None
+ */
+void clock_vset_trim(signed int trim) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { clock_trim = trim; }
+}
+
+/**
+ * @brief  Get the crystal trim applied by the 1 Hz tick.
+ * @param  None
+ * @return Correction in 1/CLOCK_TRIM_SCALE ppm.
+ */
+signed int clock_s16get_trim(void) {
+  signed int trim;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { trim = clock_trim; }
+  return trim;
+}
+
+/**
+ * @brief  Advance the time by one second (ISR context).
+ * @param  None
+ * @return None
+ */
+static void clock_vadvance(void) {
+  clock_state.now.seconds++;
+
+  if (clock_state.now.seconds >= 60) {
+    clock_state.now.seconds = 0;
+    clock_state.now.minutes++;
+  }
+
+  if (clock_state.now.minutes >= 60) {
+    clock_state.now.minutes = 0;
+    clock_state.now.hours++;
+  }
+
+  if (clock_state.now.hours >= 24) {
+    clock_state.now.hours = 0;
+    clock_state.date.day++;
+  }
+
+  if (clock_state.date.day >
+      clock_u8days_in_month(clock_state.date.month, clock_state.date.year)) {
+    clock_state.date.day = 1;
+    clock_state.date.month++;
+  }
+
+  if (clock_state.date.month > 12) {
+    clock_state.date.month = 1;
+    clock_state.date.year++;
+  }
+
+  if (clock_state.date.year > 99) {
+    clock_state.date.year = 0;
+  }
+}
+
+/**
+ * @brief  Timer2 Overflow Interrupt Service Routine (1 Hz).
+ * @param  TIMER2_OVF_vect Interrupt vector.
+ * @return None
+ */
+ISR(TIMER2_OVF_vect) {
+  CPU_LOAD_ISR_BEGIN();
+  PROFILE_BEGIN(PROF_TIMER2_ISR);
+#if BOARD_HAS_PPS_INPUT
+  calib_vcrystal_tick(); // timestamp the crystal second while calibrating
+#endif
+  clock_uptime++;
+  // The trim adds up every second; a whole second of it is inserted
+  // (crystal slow) or the tick is dropped (crystal fast).
+  clock_trim_phase += clock_trim;
+  if (clock_trim_phase >= CLOCK_TRIM_SCALE * 1000000L) {
+    clock_trim_phase -= CLOCK_TRIM_SCALE * 1000000L;
+    clock_vadvance();
+    clock_vadvance();
+  } else if (clock_trim_phase <= -CLOCK_TRIM_SCALE * 1000000L) {
+    clock_trim_phase += CLOCK_TRIM_SCALE * 1000000L;
+  } else {
+    clock_vadvance();
+  }
+  clock_state.check = clock_u16state_check();
+  clock_revision++;
+  PROFILE_END(PROF_TIMER2_ISR);
+  CPU_LOAD_ISR_END(CPU_LOAD_ISR_TIMER2);
+}
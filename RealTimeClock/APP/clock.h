@@ -0,0 +1,181 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: clock.h
+ * Description: Header file for the timekeeping core
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define CLOCK_MODE_12H 12
+#define CLOCK_MODE_24H 24
+
+/* Fields for clock_vnudge() */
+#define CLOCK_FIELD_HOURS 0
+#define CLOCK_FIELD_MINUTES 1
+#define CLOCK_FIELD_SECONDS 2
+#define CLOCK_FIELD_DAY 3
+#define CLOCK_FIELD_MONTH 4
+#define CLOCK_FIELD_YEAR 5
+
+/* Crystal trim units per ppm. A trim of +1 ppm makes the tick add one extra
+ * second every 10^6 seconds; a negative trim drops one. */
+#define CLOCK_TRIM_SCALE 16
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+/* Time of day, always kept in 24h form; 12h is a presentation of it. The
+ * core counts UTC; tz.h turns it into the local time of a zone. */
+typedef struct {
+  unsigned char hours; /* 0-23 */
+  unsigned char minutes;
+  unsigned char seconds;
+} clock_time_t;
+
+/* Calendar date of the UTC day, 2000-01-01 to 2099-12-31 */
+typedef struct {
+  unsigned char year;  /* 0-99 for 2000-2099 */
+  unsigned char month; /* 1-12 */
+  unsigned char day;   /* 1-31 */
+} clock_date_t;
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Start the 1 Hz Timer2 tick that drives the clock. After a warm
+ *         reset the time kept in .noinit resumes if its checksum holds,
+ *         otherwise the clock starts at 2000-01-01 00:00:00 in 24h mode.
+ * @param  warm Non-zero if RAM survived the reset (not a power-on reset).
+ * @return 1 if the time kept across the reset was resumed, 0 otherwise.
+ */
+unsigned char clock_u8Init(unsigned char warm);
+
+/**
+ * @brief  Set the current time.
+ * @param  time Pointer to the new time (24h form).
+ * @return None
+ */
+void clock_vSet(const clock_time_t *time);
+
+/**
+ * @brief  Set the current date.
+ * @param  date Pointer to the new date.
+ * @return None
+ */
+void clock_vSet_date(const clock_date_t *date);
+
+/**
+ * @brief  Step one field of the running time or date up or down. The field
+ *         wraps around without carrying into the next one; a day past the
+ *         end of the month after a month or year step is cut to its end.
+ * @param  field CLOCK_FIELD_* to change.
+ * @param  delta Signed step, e.g. +1 or -1.
+ * @return None
+ */
+void clock_vnudge(unsigned char field, signed char delta);
+
+/**
+ * @brief  Take a consistent snapshot of the current time.
+ * @param  time Pointer to store the time (24h form).
+ * @return None
+ */
+void clock_vGet(clock_time_t *time);
+
+/**
+ * @brief  Take a consistent snapshot of the current time and date.
+ * @param  time Pointer to store the time (24h form).
+ * @param  date Pointer to store the date.
+ * @return None
+ */
+void clock_vGet_date(clock_time_t *time, clock_date_t *date);
+
+/**
+ * @brief  Number of days in a month.
+ * @param  month 1-12.
+ * @param  year 0-99 for 2000-2099.
+ * @return 28-31.
+ */
+unsigned char clock_u8days_in_month(unsigned char month, unsigned char year);
+
+/**
+ * @brief  Number of a day counted from 2000-01-01 (day 0, a Saturday).
+ * @param  date Pointer to the date.
+ * @return 0 to 36524.
+ */
+unsigned int clock_u16day_number(const clock_date_t *date);
+
+/**
+ * @brief  Current UTC time as one number, for timestamps.
+ * @param  None
+ * @return Seconds since 2000-01-01 00:00:00 UTC.
+ */
+unsigned long clock_u32seconds(void);
+
+/**
+ * @brief  Select the display format.
+ * @param  mode CLOCK_MODE_12H or CLOCK_MODE_24H.
+ * @return None
+ */
+void clock_vSet_mode(unsigned char mode);
+
+/**
+ * @brief  Get the display format.
+ * @param  None
+ * @return CLOCK_MODE_12H or CLOCK_MODE_24H.
+ */
+unsigned char clock_u8get_mode(void);
+
+/**
+ * @brief  Convert 24h hours to the hours shown in the current mode.
+ * @param  hours Hours in 24h form (0-23).
+ * @return 0-23 in 24h mode, 1-12 in 12h mode.
+ */
+unsigned char clock_u8display_hours(unsigned char hours);
+
+/**
+ * @brief  Seconds counted by the 1 Hz tick since boot.
+ * @param  None
+ * @return The uptime in seconds.
+ */
+unsigned long clock_u32uptime(void);
+
+/**
+ * @brief  Change counter of the time and mode, so a caller can redraw only
+ *         when something changed.
+ * @param  None
+ * @return A value that differs from the last one after any tick, set, nudge
+ *         or mode change.
+ */
+unsigned char clock_u8revision(void);
+
+/**
+ * @brief  Set the crystal trim applied by the 1 Hz tick.
+ * @param  trim Correction in 1/CLOCK_TRIM_SCALE ppm, positive when the
+ *         crystal runs slow.
+ * @return None
+ */
+void clock_vset_trim(signed int trim);
+
+/**
+ * @brief  Get the crystal trim applied by the 1 Hz tick.
+ * @param  None
+ * @return Correction in 1/CLOCK_TRIM_SCALE ppm.
+ */
+signed int clock_s16get_trim(void);
+
+/**
+ * @brief  Restore time and settings saved in EEPROM before the last reset.
+ * @param  None
+ * @return 1 if a valid saved state was restored, 0 otherwise.
+ */
+unsigned char clock_u8restore(void);
+
+#endif /* CLOCK_H_ */
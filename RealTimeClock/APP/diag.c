@@ -0,0 +1,498 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: diag.c
+ * Description: Source file for the diagnostics pages
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "diag.h"
+#include "../HAL/LCD/LCD.h"
+#include "../LIB/cpu_load.h"
+#include "../MCAL/ADC/ADC.h"
+#include "../MCAL/UART/UART.h"
+#include "../MCAL/WDT/WDT.h"
+#include "calib.h"
+#include "clock.h"
+#include "eventlog.h"
+#include <util/crc16.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* One counter per MCUCSR flag, indexed by the flag's bit number */
+#define DIAG_RESET_CAUSES 5
+
+/* Seed of the .noinit checksum, so cleared RAM does not pass as valid */
+#define DIAG_RESETS_SEED 0xD1A6
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+typedef struct {
+  unsigned int count[DIAG_RESET_CAUSES];
+  unsigned int check;
+} diag_resets_t;
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static diag_resets_t diag_resets __attribute__((section(".noinit")));
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Checksum of the reset counters.
+ * @param  None
+ * @return CRC-CCITT of the counters.
+ */
+static unsigned int diag_u16resets_check(void) {
+  const unsigned char *data = (const unsigned char *)diag_resets.count;
+  unsigned int crc = DIAG_RESETS_SEED;
+  unsigned char i;
+  for (i = 0; i < sizeof(diag_resets.count); i++) {
+    crc = _crc_ccitt_update(crc, data[i]);
+  }
+  return crc;
+}
+
+/**
+ * @brief  Count the last reset per cause. The counters live in .noinit and
+ *         start over after a power-on reset.
+ * @param  cause Reset cause flags as returned by WDT_u8reset_cause().
+ * @return None
+ */
+void diag_vrecord_reset(unsigned char cause) {
+  unsigned char i;
+
+  if ((cause & WDT_RESET_POWER_ON) ||
+      diag_resets.check != diag_u16resets_check()) {
+    for (i = 0; i < DIAG_RESET_CAUSES; i++) {
+      diag_resets.count[i] = 0;
+    }
+  }
+  for (i = 0; i < DIAG_RESET_CAUSES; i++) {
+    if (((cause >> i) & 1) && diag_resets.count[i] < DIAG_COUNT_MAX) {
+      diag_resets.count[i]++;
+    }
+  }
+  diag_resets.check = diag_u16resets_check();
+}
+
+/**
+ * @brief  Number of resets of one cause since power-on.
+ * @param  cause One WDT_RESET_* flag.
+ * @return The reset count.
+ */
+unsigned int diag_u16reset_count(unsigned char cause) {
+  unsigned char i;
+  for (i = 0; i < DIAG_RESET_CAUSES; i++) {
+    if (cause == (1 << i)) {
+      return diag_resets.count[i];
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief  Convert a number to decimal digits with leading zeros.
+ * @param  value Number to convert.
+ * @param  digits Number of digits to produce (1-5).
+ * @param  text Buffer of at least digits + 1 characters.
+ * @return None
+ */
+static void diag_vformat_number(unsigned int value, unsigned char digits,
+                                char *text) {
+  text[digits] = '\0';
+  while (digits > 0) {
+    digits--;
+    text[digits] = '0' + value % 10;
+    value /= 10;
+  }
+}
+
+/**
+ * @brief  Write a number on the LCD with leading zeros.
+ * @param  value Number to write.
+ * @param  digits Number of digits to write (1-5).
+ * @return None
+ */
+static void diag_vsend_number(unsigned int value, unsigned char digits) {
+  char text[6];
+  diag_vformat_number(value, digits, text);
+  LCD_vSend_string(text);
+}
+
+/**
+ * @brief  Write a value in tenths as a decimal with one fraction digit.
+ * @param  tenths Value in tenths (e.g. 123 for 12.3).
+ * @param  digits Number of integer digits to write.
+ * @return None
+ */
+static void diag_vsend_tenths(unsigned int tenths, unsigned char digits) {
+  diag_vsend_number(tenths / 10, digits);
+  LCD_vSend_char('.');
+  LCD_vSend_char('0' + tenths % 10);
+}
+
+/**
+ * @brief  Write one ISR share as "<label> dd.d".
+ * @param  label Two-letter ISR label.
+ * @param  share Time share in tenths of a percent.
+ * @return None
+ */
+static void diag_vsend_isr_share(const char *label, unsigned int share) {
+  LCD_vSend_string(label);
+  LCD_vSend_char(' ');
+  diag_vsend_tenths((share > 999) ? 999 : share, 2);
+}
+
+/**
+ * @brief  Draw the sensors page: supply voltage, then the light reading.
+ * @param  None
+ * @return None
+ */
+static void diag_vshow_sensors(void) {
+  unsigned int supply_mv = ADC_u16supply_mv();
+#if BOARD_HAS_LIGHT_SENSOR
+  unsigned int light = ADC_u16get_filtered(LIGHT_SENSOR_ADC_CHANNEL);
+#endif
+
+  LCD_vSend_string("Supply ");
+  if (supply_mv == 0) {
+    LCD_vSend_string("-.--");
+  } else {
+    diag_vsend_number(supply_mv / 1000, 1);
+    LCD_vSend_char('.');
+    diag_vsend_number(supply_mv % 1000 / 10, 2);
+  }
+  LCD_vSend_char('V');
+  LCD_movecursor(2, 1);
+  LCD_vSend_string("Light ");
+#if BOARD_HAS_LIGHT_SENSOR
+  if (light != ADC_NO_DATA) {
+    diag_vsend_number(light, 4);
+  } else
+#endif
+  {
+    LCD_vSend_string("----");
+  }
+}
+
+/**
+ * @brief  Draw the calibration page: the crystal trim in ppm, then the
+ *         calibration state.
+ * @param  None
+ * @return None
+ */
+static void diag_vshow_calib(void) {
+  signed int trim = clock_s16get_trim();
+  unsigned long hundredths;
+
+  LCD_vSend_string("Trim ");
+  LCD_vSend_char(trim < 0 ? '-' : '+');
+  hundredths = (unsigned long)(trim < 0 ? -trim : trim) * 100 /
+               CLOCK_TRIM_SCALE;
+  diag_vsend_number(hundredths / 100, 3);
+  LCD_vSend_char('.');
+  diag_vsend_number(hundredths % 100, 2);
+  LCD_vSend_string("ppm");
+  LCD_movecursor(2, 1);
+#if BOARD_HAS_PPS_INPUT
+  switch (calib_u8state()) {
+  case CALIB_RUNNING:
+    LCD_vSend_string("Cal ");
+    diag_vsend_number(calib_u16progress(), 3);
+    LCD_vSend_char('/');
+    diag_vsend_number(CALIB_WINDOW_S, 3);
+    LCD_vSend_char('s');
+    break;
+  case CALIB_MEASURED:
+  case CALIB_DONE:
+    LCD_vSend_string("Cal done");
+    break;
+  case CALIB_FAILED:
+    LCD_vSend_string("Cal failed");
+    break;
+  default:
+    LCD_vSend_string("= calibrate");
+    break;
+  }
+#else
+  LCD_vSend_string("No 1PPS input");
+#endif
+}
+
+/**
+ * @brief  Draw the event log page: events kept and lost, then the newest
+ *         event (or the dump progress).
+ * @param  None
+ * @return None
+ */
+static void diag_vshow_events(void) {
+  eventlog_record_t last;
+
+  LCD_vSend_string("Log ");
+  diag_vsend_number(eventlog_u8count(), 2);
+  LCD_vSend_string(" Lost ");
+  diag_vsend_number(eventlog_u8dropped(), 3);
+  LCD_movecursor(2, 1);
+#if BOARD_HAS_UART
+  if (eventlog_u8dumping()) {
+    LCD_vSend_string("Dumping...");
+    return;
+  }
+#endif
+  if (!eventlog_u8last(&last)) {
+    LCD_vSend_string("No events");
+    return;
+  }
+  switch (last.type) {
+  case EVENTLOG_RESET:
+    LCD_vSend_string("Reset ");
+    break;
+  case EVENTLOG_TIME_SET:
+    LCD_vSend_string("Set ");
+    break;
+  case EVENTLOG_CALIB:
+    LCD_vSend_string("Calib ");
+    break;
+  default:
+    LCD_vSend_string("Type ");
+    diag_vsend_number(last.type, 3);
+    LCD_vSend_char(' ');
+    break;
+  }
+  diag_vsend_number(last.payload, 3);
+}
+
+#if PROFILER_ENABLED
+/**
+ * @brief  Mean of a probe's samples.
+ * @param  stats Probe statistics.
+ * @return The mean in cycles, 0 if there are no samples.
+ */
+static unsigned int diag_u16mean(const profiler_stats_t *stats) {
+  return stats->count ? (unsigned int)(stats->total / stats->count) : 0;
+}
+
+/**
+ * @brief  Write the profiler table as CSV lines
+ *         (probe,count,min,max,mean in cycles) to the serial port.
+ * @param  None
+ * @return None
+ */
+void diag_vdump_profiler(void) {
+#if BOARD_HAS_UART
+  profiler_stats_t stats;
+  char text[6];
+  unsigned char probe;
+
+  UART_vsend_string("probe,count,min,max,mean\r\n");
+  for (probe = 0; probe < PROFILER_PROBES; probe++) {
+    profiler_vget(probe, &stats);
+    if (stats.count == 0) {
+      stats.min = 0;
+    }
+    UART_vsend_string(profiler_name(probe));
+    UART_vsend_char(',');
+    diag_vformat_number(stats.count, 5, text);
+    UART_vsend_string(text);
+    UART_vsend_char(',');
+    diag_vformat_number(stats.min, 5, text);
+    UART_vsend_string(text);
+    UART_vsend_char(',');
+    diag_vformat_number(stats.max, 5, text);
+    UART_vsend_string(text);
+    UART_vsend_char(',');
+    diag_vformat_number(diag_u16mean(&stats), 5, text);
+    UART_vsend_string(text);
+    UART_vsend_string("\r\n");
+  }
+#endif
+}
+
+/**
+ * @brief  Draw the page of one probe: name and mean, then min and max.
+ * @param  probe PROF_* id.
+ * @return None
+ */
+static void diag_vshow_probe(unsigned char probe) {
+  profiler_stats_t stats;
+
+  profiler_vget(probe, &stats);
+  if (stats.count == 0) {
+    stats.min = 0;
+  }
+  LCD_vSend_string(profiler_name(probe));
+  LCD_movecursor(1, 10);
+  LCD_vSend_char('~');
+  diag_vsend_number(diag_u16mean(&stats), 5);
+  LCD_movecursor(2, 1);
+  diag_vsend_number(stats.min, 5);
+  LCD_vSend_string(" - ");
+  diag_vsend_number(stats.max, 5);
+}
+#endif
+
+#if LATENCY_TRACE_ENABLED
+/**
+ * @brief  Write the latency histograms as CSV lines (span, then the count
+ *         of each bucket) and the incomplete traces to the serial port.
+ * @param  None
+ * @return None
+ */
+void diag_vdump_latency(void) {
+#if BOARD_HAS_UART
+  latency_hist_t hist;
+  char text[6];
+  unsigned char row, bucket;
+
+  UART_vsend_string("span");
+  for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+    UART_vsend_char(',');
+    UART_vsend_string(latency_bucket_label(bucket));
+  }
+  UART_vsend_string("\r\n");
+  for (row = 0; row < LATENCY_ROWS; row++) {
+    latency_vget(row, &hist);
+    UART_vsend_string(latency_name(row));
+    for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+      UART_vsend_char(',');
+      diag_vformat_number(hist.bucket[bucket], 5, text);
+      UART_vsend_string(text);
+    }
+    UART_vsend_string("\r\n");
+  }
+  UART_vsend_string("incomplete,");
+  diag_vformat_number(latency_u16incomplete(), 5, text);
+  UART_vsend_string(text);
+  UART_vsend_string("\r\n");
+#endif
+}
+
+/**
+ * @brief  Write the bound of a latency bucket as "<512u", or ">66m" for
+ *         the last one.
+ * @param  bucket 0 to LATENCY_BUCKETS - 1.
+ * @return None
+ */
+static void diag_vsend_bound(unsigned char bucket) {
+  if (bucket < LATENCY_BUCKETS - 1) {
+    LCD_vSend_char('<');
+  }
+  LCD_vSend_string(latency_bucket_label(bucket));
+}
+
+/**
+ * @brief  Draw the page of one span: name and trace count, then the bucket
+ *         holding the median and the highest bucket used.
+ * @param  row Span row.
+ * @return None
+ */
+static void diag_vshow_latency(unsigned char row) {
+  latency_hist_t hist;
+  unsigned long count = 0, sum = 0;
+  unsigned char bucket, median = 0, top = 0;
+
+  latency_vget(row, &hist);
+  for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+    count += hist.bucket[bucket];
+    if (hist.bucket[bucket] != 0) {
+      top = bucket;
+    }
+  }
+  for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+    sum += hist.bucket[bucket];
+    if (sum * 2 >= count) {
+      median = bucket;
+      break;
+    }
+  }
+  LCD_vSend_string(latency_name(row));
+  LCD_movecursor(1, 10);
+  LCD_vSend_char('n');
+  diag_vsend_number((count > 99999) ? 99999 : (unsigned int)count, 5);
+  LCD_movecursor(2, 1);
+  if (count == 0) {
+    LCD_vSend_string("no traces");
+    return;
+  }
+  LCD_vSend_string("50%");
+  diag_vsend_bound(median);
+  LCD_movecursor(2, 10);
+  LCD_vSend_string("max");
+  diag_vsend_bound(top);
+}
+#endif
+
+/**
+ * @brief  Draw one diagnostics page on the LCD.
+ * @param  page DIAG_PAGE_* index.
+ * @return None
+ */
+void diag_vshow(unsigned char page) {
+  LCD_clearscreen();
+  switch (page) {
+  case DIAG_PAGE_LOAD:
+    LCD_vSend_string("CPU load ");
+    diag_vsend_tenths(cpu_load_u16busy(), 3);
+    LCD_vSend_char('%');
+    LCD_movecursor(2, 1);
+    LCD_vSend_string("Idle pass ");
+    diag_vsend_number(cpu_load_u16idle_pass(), 5);
+    break;
+  case DIAG_PAGE_ISR: // time share of each ISR in %
+    // the display refresh includes the SPI bytes it starts
+    diag_vsend_isr_share("T0", cpu_load_u16isr_share(CPU_LOAD_ISR_TIMER0) +
+                                   cpu_load_u16isr_share(CPU_LOAD_ISR_SPI));
+    LCD_vSend_string("  ");
+    diag_vsend_isr_share("T2", cpu_load_u16isr_share(CPU_LOAD_ISR_TIMER2));
+    LCD_movecursor(2, 1);
+    diag_vsend_isr_share("AD", cpu_load_u16isr_share(CPU_LOAD_ISR_ADC));
+    LCD_vSend_string("  ");
+    // EEPROM, UART, TWI and the calibration Timer1 capture and overflow
+    // together: they only run while something moves or is measured
+    diag_vsend_isr_share("IO", cpu_load_u16isr_share(CPU_LOAD_ISR_EEPROM) +
+                                   cpu_load_u16isr_share(CPU_LOAD_ISR_UART) +
+                                   cpu_load_u16isr_share(CPU_LOAD_ISR_TWI) +
+                                   cpu_load_u16isr_share(CPU_LOAD_ISR_TIMER1));
+    break;
+  case DIAG_PAGE_SENSORS:
+    diag_vshow_sensors();
+    break;
+  case DIAG_PAGE_CALIB:
+    diag_vshow_calib();
+    break;
+  case DIAG_PAGE_EVENTS:
+    diag_vshow_events();
+    break;
+  case DIAG_PAGE_RESETS:
+    LCD_vSend_string("WDT  BOD  EXT");
+    LCD_movecursor(2, 1);
+    diag_vsend_number(diag_u16reset_count(WDT_RESET_WATCHDOG), 4);
+    LCD_vSend_char(' ');
+    diag_vsend_number(diag_u16reset_count(WDT_RESET_BROWN_OUT), 4);
+    LCD_vSend_char(' ');
+    diag_vsend_number(diag_u16reset_count(WDT_RESET_EXTERNAL), 4);
+    break;
+  default:
+#if LATENCY_TRACE_ENABLED
+    if (page >= DIAG_PAGE_LATENCY && page < DIAG_PAGE_AFTER_LATENCY) {
+      diag_vshow_latency(page - DIAG_PAGE_LATENCY);
+    }
+#endif
+#if PROFILER_ENABLED
+    if (page >= DIAG_PAGE_PROFILER &&
+        page < DIAG_PAGE_PROFILER + PROFILER_PROBES) {
+      diag_vshow_probe(page - DIAG_PAGE_PROFILER);
+    }
+#endif
+    break;
+  }
+}
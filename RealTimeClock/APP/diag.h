@@ -0,0 +1,90 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: diag.h
+ * Description: Header file for the diagnostics pages
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef DIAG_H_
+#define DIAG_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "../LIB/latency.h"
+#include "../LIB/profiler.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Pages shown in turn by the '*' key on the run screen */
+#define DIAG_PAGE_LOAD 0
+#define DIAG_PAGE_ISR 1
+#define DIAG_PAGE_RESETS 2
+#define DIAG_PAGE_SENSORS 3
+#define DIAG_PAGE_CALIB 4  // '=' starts a calibration on 1PPS boards
+#define DIAG_PAGE_EVENTS 5 // '=' dumps the event log on UART boards
+#if LATENCY_TRACE_ENABLED
+#define DIAG_PAGE_LATENCY 6 // one page per span
+#define DIAG_PAGE_AFTER_LATENCY (DIAG_PAGE_LATENCY + LATENCY_ROWS)
+#else
+#define DIAG_PAGE_AFTER_LATENCY 6
+#endif
+#if PROFILER_ENABLED
+#define DIAG_PAGE_PROFILER DIAG_PAGE_AFTER_LATENCY // one page per probe
+#define DIAG_PAGES (DIAG_PAGE_PROFILER + PROFILER_PROBES)
+#else
+#define DIAG_PAGES DIAG_PAGE_AFTER_LATENCY
+#endif
+
+/* Reset counters stop here so they always fit their LCD column */
+#define DIAG_COUNT_MAX 9999
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Count the last reset per cause. The counters live in .noinit and
+ *         start over after a power-on reset.
+ * @param  cause Reset cause flags as returned by WDT_u8reset_cause().
+ * @return None
+ */
+void diag_vrecord_reset(unsigned char cause);
+
+/**
+ * @brief  Number of resets of one cause since power-on.
+ * @param  cause One WDT_RESET_* flag.
+ * @return The reset count.
+ */
+unsigned int diag_u16reset_count(unsigned char cause);
+
+#if PROFILER_ENABLED
+/**
+ * @brief  Write the profiler table as CSV lines
+ *         (probe,count,min,max,mean in cycles) to the serial port.
+ * @param  None
+ * @return None
+ */
+void diag_vdump_profiler(void);
+#endif
+
+#if LATENCY_TRACE_ENABLED
+/**
+ * @brief  Write the latency histograms as CSV lines (span, then the count
+ *         of each bucket) and the incomplete traces to the serial port.
+ * @param  None
+ * @return None
+ */
+void diag_vdump_latency(void);
+#endif
+
+/**
+ * @brief  Draw one diagnostics page on the LCD.
+ * @param  page DIAG_PAGE_* index.
+ * @return None
+ */
+void diag_vshow(unsigned char page);
+
+#endif /* DIAG_H_ */
@@ -0,0 +1,315 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: eventlog.c
+ * Description: Source file for the timestamped event log in EEPROM
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "eventlog.h"
+#include "../MCAL/EEPROM/EEPROM.h"
+#include "../MCAL/UART/UART.h"
+#include "clock.h"
+#include <util/crc16.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Seed of the record checksum, so an erased EEPROM does not pass as valid */
+#define EVENTLOG_CHECK_SEED 0x5A
+
+/* Records per EEPROM write */
+#define EVENTLOG_BATCH (EEPROM_WRITE_BUFFER_SIZE / sizeof(eventlog_record_t))
+
+/* Dump phases */
+#define EVENTLOG_DUMP_IDLE 0
+#define EVENTLOG_DUMP_HEADER 1
+#define EVENTLOG_DUMP_RECORDS 2
+#define EVENTLOG_DUMP_TRAILER 3
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+/* EEPROM ring */
+static unsigned char eventlog_next_slot = 0; // slot of the next write
+static unsigned char eventlog_count = 0;     // records in the ring
+static unsigned char eventlog_sequence = 0;  // sequence of the next event
+
+/* RAM stage of events not written yet, oldest at the tail */
+static eventlog_record_t eventlog_stage[EVENTLOG_STAGE_SIZE];
+static unsigned char eventlog_stage_head = 0;
+static unsigned char eventlog_stage_count = 0;
+static unsigned long eventlog_stage_since; // uptime of the oldest wait
+static unsigned char eventlog_dropped = 0;
+
+static eventlog_record_t eventlog_last;
+static unsigned char eventlog_have_last = 0;
+
+#if BOARD_HAS_UART
+static unsigned char eventlog_dump_phase = EVENTLOG_DUMP_IDLE;
+static unsigned char eventlog_dump_slot;
+static unsigned char eventlog_dump_left; // records still to send
+static unsigned int eventlog_dump_crc;
+#endif
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Checksum of a record (all bytes except the checksum itself).
+ * @param  record Pointer to the record.
+ * @return CRC-8 of the record.
+ */
+static unsigned char eventlog_u8check(const eventlog_record_t *record) {
+  const unsigned char *bytes = (const unsigned char *)record;
+  unsigned char crc = EVENTLOG_CHECK_SEED;
+  unsigned char i;
+  for (i = 0; i < sizeof(eventlog_record_t) - sizeof(record->check); i++) {
+    crc = _crc8_ccitt_update(crc, bytes[i]);
+  }
+  return crc;
+}
+
+/**
+ * @brief  Scan the event ring for the newest record and count the records.
+ * @param  None
+ * @return None
+ */
+void eventlog_vInit(void) {
+  eventlog_record_t record;
+  unsigned char slot;
+
+  eventlog_count = 0;
+  eventlog_next_slot = 0;
+  for (slot = 0; slot < EVENTLOG_SLOTS; slot++) {
+    EEPROM_vread_block(EVENTLOG_BASE_ADDRESS +
+                           slot * sizeof(eventlog_record_t),
+                       (unsigned char *)&record, sizeof(record));
+    if (record.type == 0xFF || record.check != eventlog_u8check(&record)) {
+      continue; // erased, torn by a reset during the write, or corrupted
+    }
+    eventlog_count++;
+    /* sequence numbers wrap; within one ring they differ by less than 128 */
+    if (!eventlog_have_last ||
+        (signed char)(record.sequence - eventlog_last.sequence) > 0) {
+      eventlog_last = record;
+      eventlog_have_last = 1;
+      eventlog_next_slot = (slot + 1) % EVENTLOG_SLOTS;
+    }
+  }
+  if (eventlog_have_last) {
+    eventlog_sequence = eventlog_last.sequence + 1;
+  }
+}
+
+/**
+ * @brief  Log an event with the current time. Called from the run loop,
+ *         not from an ISR; never waits for the EEPROM.
+ * @param  type EVENTLOG_* type.
+ * @param  payload Event data.
+ * @return None
+ */
+void eventlog_vadd(unsigned char type, unsigned char payload) {
+  eventlog_record_t *record;
+
+  if (eventlog_stage_count == EVENTLOG_STAGE_SIZE) {
+    if (eventlog_dropped < 0xFF) {
+      eventlog_dropped++; // the EEPROM cannot keep up, keep the older events
+    }
+    return;
+  }
+  if (eventlog_stage_count == 0) {
+    eventlog_stage_since = clock_u32uptime();
+  }
+  record = &eventlog_stage[eventlog_stage_head];
+  record->time = clock_u32seconds();
+  record->type = type;
+  record->payload = payload;
+  record->sequence = eventlog_sequence++;
+  record->check = eventlog_u8check(record);
+  eventlog_last = *record;
+  eventlog_have_last = 1;
+  eventlog_stage_head = (eventlog_stage_head + 1) & (EVENTLOG_STAGE_SIZE - 1);
+  eventlog_stage_count++;
+}
+
+/**
+ * @brief  Write the oldest staged events as one EEPROM block once a batch is
+ *         full or has waited EVENTLOG_HOLD_S.
+ * @param  None
+ * @return None
+ */
+static void eventlog_vflush(void) {
+  eventlog_record_t batch[EVENTLOG_BATCH];
+  unsigned char tail;
+  unsigned char count;
+  unsigned char i;
+
+  if (eventlog_stage_count == 0 || EEPROM_u8is_busy()) {
+    return;
+  }
+  if (eventlog_stage_count < EVENTLOG_BATCH &&
+      (clock_u32uptime() - eventlog_stage_since) < EVENTLOG_HOLD_S) {
+    return; // wait for more events to share the write
+  }
+  count = (eventlog_stage_count < EVENTLOG_BATCH) ? eventlog_stage_count
+                                                   : EVENTLOG_BATCH;
+  if (count > EVENTLOG_SLOTS - eventlog_next_slot) {
+    count = EVENTLOG_SLOTS - eventlog_next_slot; // a block never wraps
+  }
+  tail = (eventlog_stage_head - eventlog_stage_count) &
+         (EVENTLOG_STAGE_SIZE - 1);
+  for (i = 0; i < count; i++) {
+    batch[i] = eventlog_stage[(tail + i) & (EVENTLOG_STAGE_SIZE - 1)];
+  }
+  if (EEPROM_u8write_block_async(EVENTLOG_BASE_ADDRESS +
+                                     eventlog_next_slot *
+                                         sizeof(eventlog_record_t),
+                                 (const unsigned char *)batch,
+                                 count * sizeof(eventlog_record_t))) {
+    // the driver copied the block, the stage entries are free again
+    eventlog_stage_count -= count;
+    eventlog_stage_since = clock_u32uptime();
+    eventlog_next_slot = (eventlog_next_slot + count) % EVENTLOG_SLOTS;
+    eventlog_count = (eventlog_count + count > EVENTLOG_SLOTS)
+                         ? EVENTLOG_SLOTS
+                         : eventlog_count + count;
+  }
+}
+
+#if BOARD_HAS_UART
+/**
+ * @brief  Queue bytes of the dump frame and add them to its checksum.
+ * @param  bytes Pointer to the bytes.
+ * @param  length Number of bytes, at most the free room of the UART buffer.
+ * @return None
+ */
+static void eventlog_vsend(const unsigned char *bytes, unsigned char length) {
+  while (length--) {
+    eventlog_dump_crc = _crc_ccitt_update(eventlog_dump_crc, *bytes);
+    UART_vsend_char(*bytes++);
+  }
+}
+
+/**
+ * @brief  Send as much of the dump as the transmit buffer takes now.
+ * @param  None
+ * @return None
+ */
+static void eventlog_vdump_step(void) {
+  eventlog_record_t record;
+  unsigned char header[5];
+
+  switch (eventlog_dump_phase) {
+  case EVENTLOG_DUMP_HEADER:
+    if (UART_u8tx_free() < sizeof(header)) {
+      return;
+    }
+    header[0] = (unsigned char)EVENTLOG_DUMP_MAGIC;
+    header[1] = (unsigned char)(EVENTLOG_DUMP_MAGIC >> 8);
+    header[2] = EVENTLOG_DUMP_VERSION;
+    header[3] = eventlog_dump_left;
+    header[4] = eventlog_dropped;
+    eventlog_dump_crc = 0xFFFF;
+    eventlog_vsend(header, sizeof(header));
+    eventlog_dump_phase = EVENTLOG_DUMP_RECORDS;
+    break;
+  case EVENTLOG_DUMP_RECORDS:
+    while (eventlog_dump_left > 0 &&
+           UART_u8tx_free() >= sizeof(eventlog_record_t)) {
+      if (EEPROM_u8is_busy()) {
+        return; // reading would wait for the write
+      }
+      EEPROM_vread_block(EVENTLOG_BASE_ADDRESS +
+                             eventlog_dump_slot * sizeof(eventlog_record_t),
+                         (unsigned char *)&record, sizeof(record));
+      eventlog_vsend((const unsigned char *)&record, sizeof(record));
+      eventlog_dump_slot = (eventlog_dump_slot + 1) % EVENTLOG_SLOTS;
+      eventlog_dump_left--;
+    }
+    if (eventlog_dump_left == 0) {
+      eventlog_dump_phase = EVENTLOG_DUMP_TRAILER;
+    }
+    break;
+  case EVENTLOG_DUMP_TRAILER:
+    if (UART_u8tx_free() < 2) {
+      return;
+    }
+    UART_vsend_char((char)eventlog_dump_crc);
+    UART_vsend_char((char)(eventlog_dump_crc >> 8));
+    eventlog_dump_phase = EVENTLOG_DUMP_IDLE;
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief  Start streaming the event ring to the serial port as one binary
+ *         frame.
+ * @param  None
+ * @return None
+ */
+void eventlog_vstart_dump(void) {
+  if (eventlog_dump_phase != EVENTLOG_DUMP_IDLE) {
+    return;
+  }
+  // oldest first; events still staged go out with the next dump
+  eventlog_dump_left = eventlog_count;
+  eventlog_dump_slot =
+      (eventlog_next_slot + EVENTLOG_SLOTS - eventlog_count) % EVENTLOG_SLOTS;
+  eventlog_dump_phase = EVENTLOG_DUMP_HEADER;
+}
+
+/**
+ * @brief  Check whether a dump is still being sent.
+ * @param  None
+ * @return 1 while dumping, 0 otherwise.
+ */
+unsigned char eventlog_u8dumping(void) {
+  return eventlog_dump_phase != EVENTLOG_DUMP_IDLE;
+}
+#endif
+
+/**
+ * @brief  Write staged events and stream a running dump. Called from the
+ *         run loop; never waits for the EEPROM or the UART.
+ * @param  None
+ * @return None
+ */
+void eventlog_vtask(void) {
+#if BOARD_HAS_UART
+  eventlog_vdump_step();
+#endif
+  eventlog_vflush();
+}
+
+/**
+ * @brief  Number of events kept in the EEPROM ring.
+ * @param  None
+ * @return 0 to EVENTLOG_SLOTS.
+ */
+unsigned char eventlog_u8count(void) { return eventlog_count; }
+
+/**
+ * @brief  Number of events lost because the stage was full.
+ * @param  None
+ * @return The count, stops at 255.
+ */
+unsigned char eventlog_u8dropped(void) { return eventlog_dropped; }
+
+/**
+ * @brief  Get the newest event, staged or written.
+ * @param  record Pointer to store the event.
+ * @return 1 if there is an event, 0 otherwise.
+ */
+unsigned char eventlog_u8last(eventlog_record_t *record) {
+  if (eventlog_have_last) {
+    *record = eventlog_last;
+  }
+  return eventlog_have_last;
+}
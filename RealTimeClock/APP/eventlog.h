@@ -0,0 +1,129 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: eventlog.h
+ * Description: Header file for the timestamped event log in EEPROM
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef EVENTLOG_H_
+#define EVENTLOG_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "../LIB/board_pinmap.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Events are 8-byte records (UTC timestamp, type, payload, sequence, CRC-8)
+ * in a ring after the calibration record, 0x110-0x3EF. New events wait in a
+ * RAM stage and are written EVENTLOG_BATCH at a time by the interrupt-driven
+ * EEPROM driver, so logging never waits for the EEPROM. The oldest record is
+ * overwritten when the ring is full.
+ */
+#define EVENTLOG_BASE_ADDRESS 0x110
+#define EVENTLOG_SLOTS 92
+#define EVENTLOG_STAGE_SIZE 8 // events waiting for the EEPROM, power of 2
+
+/* Staged events are written once a batch is full or the oldest has waited
+ * this long */
+#define EVENTLOG_HOLD_S 10
+
+/* Event types */
+#define EVENTLOG_RESET 1    // payload: WDT_RESET_* flags
+#define EVENTLOG_TIME_SET 2 // payload: EVENTLOG_SET_*
+#define EVENTLOG_CALIB 3    // payload: CALIB_DONE or CALIB_FAILED
+
+/* Payloads of EVENTLOG_TIME_SET */
+#define EVENTLOG_SET_ENTRY 0  // time typed in
+#define EVENTLOG_SET_ADJUST 1 // fields nudged in adjust mode
+#define EVENTLOG_SET_SYNC 2   // stepped to the RTC chip
+
+/* Serial dump frame: EVENTLOG_DUMP_MAGIC (2 bytes), version, record count,
+ * dropped events, the records oldest first as stored, then the
+ * CRC-CCITT (seed 0xFFFF, low byte first) of everything before it */
+#define EVENTLOG_DUMP_MAGIC 0x4CE5 // 0xE5 'L' on the wire
+#define EVENTLOG_DUMP_VERSION 1
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+typedef struct {
+  unsigned long time;     /* UTC seconds since 2000-01-01 */
+  unsigned char type;     /* EVENTLOG_* */
+  unsigned char payload;
+  unsigned char sequence; /* wraps, newest is the one no other record follows */
+  unsigned char check;    /* CRC-8 over the bytes above */
+} eventlog_record_t;
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Scan the event ring for the newest record and count the records.
+ * @param  None
+ * @return None
+ */
+void eventlog_vInit(void);
+
+/**
+ * @brief  Log an event with the current time. Called from the run loop,
+ *         not from an ISR; never waits for the EEPROM.
+ * @param  type EVENTLOG_* type.
+ * @param  payload Event data.
+ * @return None
+ */
+void eventlog_vadd(unsigned char type, unsigned char payload);
+
+/**
+ * @brief  Write staged events and stream a running dump. Called from the
+ *         run loop; never waits for the EEPROM or the UART.
+ * @param  None
+ * @return None
+ */
+void eventlog_vtask(void);
+
+/**
+ * @brief  Number of events kept in the EEPROM ring.
+ * @param  None
+ * @return 0 to EVENTLOG_SLOTS.
+ */
+unsigned char eventlog_u8count(void);
+
+/**
+ * @brief  Number of events lost because the stage was full.
+ * @param  None
+ * @return The count, stops at 255.
+ */
+unsigned char eventlog_u8dropped(void);
+
+/**
+ * @brief  Get the newest event, staged or written.
+ * @param  record Pointer to store the event.
+ * @return 1 if there is an event, 0 otherwise.
+ */
+unsigned char eventlog_u8last(eventlog_record_t *record);
+
+#if BOARD_HAS_UART
+/**
+ * @brief  Start streaming the event ring to the serial port as one binary
+ *         frame. The records are sent by eventlog_vtask() as the transmit
+ *         buffer drains.
+ * @param  None
+ * @return None
+ */
+void eventlog_vstart_dump(void);
+
+/**
+ * @brief  Check whether a dump is still being sent.
+ * @param  None
+ * @return 1 while dumping, 0 otherwise.
+ */
+unsigned char eventlog_u8dumping(void);
+#endif
+
+#endif /* EVENTLOG_H_ */
@@ -0,0 +1,215 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: rtcsync.c
+ * Description: Source file for the backup and sync with the RTC chip
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "rtcsync.h"
+
+#if BOARD_HAS_EXT_RTC
+#include "../HAL/DS1307/DS1307.h"
+#include "clock.h"
+#include "eventlog.h"
+#include <util/atomic.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define F_CPU 8000000UL
+#include <util/delay.h>
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static unsigned char rtcsync_write_pending = 0; // the chip needs our time
+static unsigned char rtcsync_busy = 0;          // a transfer is out
+static unsigned char rtcsync_reading;           // it is a read
+static unsigned long rtcsync_started;           // uptime at its start
+static unsigned long rtcsync_due = 0;           // uptime of the next one
+
+/* Bumped by every set, so a transfer started before it does not count */
+static unsigned char rtcsync_generation = 0;
+static unsigned char rtcsync_start_generation;
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Take the chip time of the last read if it is a valid date.
+ * @param  chip Pointer to store the chip time.
+ * @return 1 if valid, 0 otherwise.
+ */
+static unsigned char rtcsync_u8chip_time(ds1307_time_t *chip) {
+  return DS1307_u8get(chip) &&
+         chip->day <= clock_u8days_in_month(chip->month, chip->year);
+}
+
+/**
+ * @brief  Set the clock to the chip time in one step.
+ * @param  chip Pointer to the chip time.
+ * @return None
+ */
+static void rtcsync_vapply(const ds1307_time_t *chip) {
+  clock_time_t time = {chip->hours, chip->minutes, chip->seconds};
+  clock_date_t date = {chip->year, chip->month, chip->day};
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    clock_vSet(&time);
+    clock_vSet_date(&date);
+  }
+}
+
+/**
+ * @brief  Chip time as seconds since 2000-01-01 00:00:00.
+ * @param  chip Pointer to the chip time.
+ * @return The seconds.
+ */
+static unsigned long rtcsync_u32seconds(const ds1307_time_t *chip) {
+  clock_date_t date = {chip->year, chip->month, chip->day};
+  return clock_u16day_number(&date) * 86400UL + chip->hours * 3600UL +
+         chip->minutes * 60U + chip->seconds;
+}
+
+/**
+ * @brief  Queue the boot read of the chip.
+ * @param  None
+ * @return None
+ */
+void rtcsync_vInit(void) { DS1307_u8start_read(); }
+
+/**
+ * @brief  Set the clock from the boot read.
+ * @param  None
+ * @return 1 if the clock was set from the chip, 0 otherwise.
+ */
+unsigned char rtcsync_u8load(void) {
+  unsigned char wait = RTCSYNC_BOOT_WAIT_MS;
+  ds1307_time_t chip;
+
+  while (DS1307_u8status() == TWI_PENDING && wait != 0) {
+    _delay_ms(1);
+    wait--;
+  }
+  switch (DS1307_u8status()) {
+  case TWI_DONE:
+    if (rtcsync_u8chip_time(&chip)) {
+      rtcsync_vapply(&chip);
+      return 1;
+    }
+    rtcsync_write_pending = 1; // halted or garbage: give it our time
+    break;
+  case TWI_PENDING:
+    TWI_vreset(); // SDA or SCL held low
+    break;
+  default: // no chip fitted
+    break;
+  }
+  return 0;
+}
+
+/**
+ * @brief  Note that the time was set from the keypad.
+ * @param  None
+ * @return None
+ */
+void rtcsync_vtime_set(void) {
+  rtcsync_write_pending = 1;
+  rtcsync_generation++;
+  rtcsync_due = clock_u32uptime() + 1;
+}
+
+/**
+ * @brief  Handle a finished transfer: apply a read, or reschedule a write
+ *         that failed.
+ * @param  status TWI_* result.
+ * @return None
+ */
+static void rtcsync_vfinish(unsigned char status) {
+  ds1307_time_t chip;
+  signed long offset;
+
+  rtcsync_busy = 0;
+  if (!rtcsync_reading) {
+    if (status == TWI_DONE &&
+        rtcsync_start_generation == rtcsync_generation) {
+      rtcsync_write_pending = 0; // no set came in since it was sent
+    }
+    return;
+  }
+  if (status != TWI_DONE || rtcsync_start_generation != rtcsync_generation) {
+    return; // no chip, or the time was set meanwhile: try next period
+  }
+  if (!rtcsync_u8chip_time(&chip)) {
+    rtcsync_write_pending = 1;
+    rtcsync_due = clock_u32uptime(); // at the next tick
+    return;
+  }
+  // read just after our tick: a whole second of offset is real drift
+  offset = (signed long)(rtcsync_u32seconds(&chip) - clock_u32seconds());
+  if (offset != 0) {
+    rtcsync_vapply(&chip);
+    eventlog_vadd(EVENTLOG_TIME_SET, EVENTLOG_SET_SYNC);
+  }
+}
+
+/**
+ * @brief  Start and finish the chip transfers.
+ * @param  None
+ * @return None
+ */
+void rtcsync_vtask(void) {
+  static unsigned long last_uptime = 0;
+  unsigned long uptime = clock_u32uptime();
+  unsigned char status, fresh;
+  clock_time_t now;
+  clock_date_t date;
+  ds1307_time_t chip;
+
+  if (rtcsync_busy) {
+    status = DS1307_u8status();
+    if (status == TWI_PENDING) {
+      if (uptime - rtcsync_started > RTCSYNC_TIMEOUT_S) {
+        TWI_vreset(); // the status becomes TWI_ERROR
+      }
+      return;
+    }
+    rtcsync_vfinish(status);
+  }
+
+  // start transfers just after a tick seen by the last pass, so the chip
+  // and the clock agree on the second and a written chip starts in phase
+  if (uptime == last_uptime) {
+    return;
+  }
+  fresh = (uptime == last_uptime + 1);
+  last_uptime = uptime;
+  if (!fresh || (signed long)(uptime - rtcsync_due) < 0) {
+    return;
+  }
+  if (rtcsync_write_pending) {
+    clock_vGet_date(&now, &date);
+    chip.seconds = now.seconds;
+    chip.minutes = now.minutes;
+    chip.hours = now.hours;
+    chip.weekday = (clock_u16day_number(&date) + 6) % 7 + 1; // Sunday = 1
+    chip.day = date.day;
+    chip.month = date.month;
+    chip.year = date.year;
+    rtcsync_reading = 0;
+    rtcsync_busy = DS1307_u8start_write(&chip);
+  } else {
+    rtcsync_reading = 1;
+    rtcsync_busy = DS1307_u8start_read();
+  }
+  if (rtcsync_busy) {
+    rtcsync_started = uptime;
+    rtcsync_start_generation = rtcsync_generation;
+    rtcsync_due = uptime + RTCSYNC_PERIOD_S;
+  }
+}
+#endif /* BOARD_HAS_EXT_RTC */
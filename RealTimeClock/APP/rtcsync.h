@@ -0,0 +1,75 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: rtcsync.h
+ * Description: Header file for the backup and sync with the RTC chip
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef RTCSYNC_H_
+#define RTCSYNC_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "../LIB/board_pinmap.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * The battery-backed DS1307/DS3231 keeps UTC through a power loss. At a
+ * cold boot the clock is loaded from it; the chip is written only when the
+ * time is set from the keypad (or the chip was halted); and every
+ * RTCSYNC_PERIOD_S the chip is read just after a tick of the Timer2 clock,
+ * which is stepped to the chip when they differ by a second. All transfers
+ * run on the TWI interrupt; the run loop only starts them and takes the
+ * result.
+ */
+#define RTCSYNC_PERIOD_S 600
+
+/* A transfer still pending after this long is dropped (bus stuck) */
+#define RTCSYNC_TIMEOUT_S 2
+
+/* Longest wait for the boot read, which runs during the LCD start-up */
+#define RTCSYNC_BOOT_WAIT_MS 10
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+#if BOARD_HAS_EXT_RTC
+/**
+ * @brief  Queue the boot read of the chip. Needs TWI_vInit() first; the
+ *         read runs once interrupts are enabled.
+ * @param  None
+ * @return None
+ */
+void rtcsync_vInit(void);
+
+/**
+ * @brief  Set the clock from the boot read, waiting at most
+ *         RTCSYNC_BOOT_WAIT_MS for it to finish.
+ * @param  None
+ * @return 1 if the clock was set from the chip, 0 if there is no chip or
+ *         it holds no valid time (it is then written once the clock runs).
+ */
+unsigned char rtcsync_u8load(void);
+
+/**
+ * @brief  Note that the time was set from the keypad, so the chip gets it
+ *         at the next tick.
+ * @param  None
+ * @return None
+ */
+void rtcsync_vtime_set(void);
+
+/**
+ * @brief  Start and finish the chip transfers. Called from the run loop
+ *         while the clock runs; never waits for the bus.
+ * @param  None
+ * @return None
+ */
+void rtcsync_vtask(void);
+#endif
+
+#endif /* RTCSYNC_H_ */
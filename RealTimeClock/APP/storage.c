@@ -0,0 +1,139 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: storage.c
+ * Description: Source file for the EEPROM persistence of time and settings
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "storage.h"
+#include "../MCAL/EEPROM/EEPROM.h"
+#include "clock.h"
+#include "tz.h"
+#include <util/crc16.h>
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static storage_record_t storage_newest;
+static unsigned char storage_valid = 0;     // storage_newest holds a record
+static unsigned char storage_next_slot = 0; // slot of the next save
+static unsigned char storage_dirty = 0;
+static unsigned char storage_saved = 0; // a record was written since boot
+static unsigned long storage_last_save = 0;
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Compute the CRC of a record (all bytes except the CRC itself).
+ * @param  record Pointer to the record.
+ * @return The CRC-CCITT value.
+ */
+static unsigned int record_crc(const storage_record_t *record) {
+  const unsigned char *bytes = (const unsigned char *)record;
+  unsigned int crc = 0xFFFF;
+  unsigned char i;
+  for (i = 0; i < sizeof(storage_record_t) - sizeof(record->crc); i++) {
+    crc = _crc_ccitt_update(crc, bytes[i]);
+  }
+  return crc;
+}
+
+/**
+ * @brief  Scan the record ring and locate the newest valid record.
+ * @param  None
+ * @return None
+ */
+void storage_vInit(void) {
+  storage_record_t record;
+  unsigned char slot;
+
+  storage_valid = 0;
+  storage_next_slot = 0;
+  for (slot = 0; slot < STORAGE_SLOTS; slot++) {
+    EEPROM_vread_block(STORAGE_BASE_ADDRESS + slot * sizeof(storage_record_t),
+                       (unsigned char *)&record, sizeof(record));
+    if (record.crc != record_crc(&record)) {
+      continue; // erased, torn by a reset during the write, or corrupted
+    }
+    /* sequence numbers wrap; within one ring they differ by less than 128 */
+    if (!storage_valid ||
+        (signed char)(record.sequence - storage_newest.sequence) > 0) {
+      storage_newest = record;
+      storage_valid = 1;
+      storage_next_slot = (slot + 1) % STORAGE_SLOTS;
+    }
+  }
+}
+
+/**
+ * @brief  Get the newest valid record found by storage_vInit().
+ * @param  record Pointer to store the record.
+ * @return 1 if a valid record exists, 0 otherwise.
+ */
+unsigned char storage_u8load(storage_record_t *record) {
+  if (storage_valid) {
+    *record = storage_newest;
+  }
+  return storage_valid;
+}
+
+/**
+ * @brief  Mark the settings as changed.
+ * @param  None
+ * @return None
+ */
+void storage_vrequest_save(void) { storage_dirty = 1; }
+
+/**
+ * @brief  Save the current time and settings when a save is due.
+ * @param  None
+ * @return None
+ */
+void storage_vtask(void) {
+  storage_record_t record;
+  clock_time_t now;
+  clock_date_t date;
+  unsigned long uptime = clock_u32uptime();
+
+  /* at most one record per interval; a settings change is only written
+   * early when nothing has been saved since boot */
+  if ((uptime - storage_last_save) < STORAGE_SAVE_INTERVAL_S &&
+      !(storage_dirty && !storage_saved)) {
+    return;
+  }
+  if (EEPROM_u8is_busy()) {
+    return;
+  }
+
+  clock_vGet_date(&now, &date);
+  record.sequence = storage_valid ? storage_newest.sequence + 1 : 0;
+  record.mode = clock_u8get_mode();
+  record.hours = now.hours;
+  record.minutes = now.minutes;
+  record.seconds = now.seconds;
+  record.year = date.year;
+  record.month = date.month;
+  record.day = date.day;
+  record.zone = tz_u8get_world();
+  record.reserved = 0;
+  record.crc = record_crc(&record);
+
+  if (EEPROM_u8write_block_async(STORAGE_BASE_ADDRESS +
+                                     storage_next_slot *
+                                         sizeof(storage_record_t),
+                                 (const unsigned char *)&record,
+                                 sizeof(record))) {
+    storage_newest = record;
+    storage_valid = 1;
+    storage_next_slot = (storage_next_slot + 1) % STORAGE_SLOTS;
+    storage_dirty = 0;
+    storage_saved = 1;
+    storage_last_save = uptime;
+  }
+}
@@ -0,0 +1,79 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: storage.h
+ * Description: Header file for the EEPROM persistence of time and settings
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Ring of fixed-size records at the start of the EEPROM (21 x 12 = 252
+ * bytes). Each save goes to the next slot, so every cell sees 1/21 of the
+ * writes. */
+#define STORAGE_BASE_ADDRESS 0x000
+#define STORAGE_SLOTS 21
+
+/* Minimum time between two records. With 21 slots and the 100k cycle
+ * endurance of the ATmega32 EEPROM, 300s gives ~20 years of continuous
+ * running (60s still gives ~4 years). */
+#ifndef STORAGE_SAVE_INTERVAL_S
+#define STORAGE_SAVE_INTERVAL_S 300
+#endif
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+typedef struct {
+  unsigned char sequence; /* wraps, newest is the one no other record follows */
+  unsigned char mode;     /* CLOCK_MODE_12H or CLOCK_MODE_24H */
+  unsigned char hours;    /* UTC, 24h form */
+  unsigned char minutes;
+  unsigned char seconds;
+  unsigned char year; /* UTC date, 0-99 for 2000-2099 */
+  unsigned char month;
+  unsigned char day;
+  unsigned char zone; /* TZ_* zone shown on the LCD */
+  unsigned char reserved;
+  unsigned int crc; /* CRC-CCITT over the bytes above */
+} storage_record_t;
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Scan the record ring and locate the newest valid record.
+ * @param  None
+ * @return None
+ */
+void storage_vInit(void);
+
+/**
+ * @brief  Get the newest valid record found by storage_vInit().
+ * @param  record Pointer to store the record.
+ * @return 1 if a valid record exists, 0 otherwise.
+ */
+unsigned char storage_u8load(storage_record_t *record);
+
+/**
+ * @brief  Mark the settings as changed; they are written at the next allowed
+ * save (immediately if nothing was saved since boot).
+ * @param  None
+ * @return None
+ */
+void storage_vrequest_save(void);
+
+/**
+ * @brief  Save the current time and settings when a save is due. Called from
+ * the run loop; never waits for the EEPROM.
+ * @param  None
+ * @return None
+ */
+void storage_vtask(void);
+
+#endif /* STORAGE_H_ */
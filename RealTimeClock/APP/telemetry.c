@@ -0,0 +1,164 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: telemetry.c
+ * Description: Source file for the binary health telemetry on the UART
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "telemetry.h"
+#include "../HAL/Keypad/keypad_driver.h"
+#include "../HAL/SevenSegment/seven segment_config.h"
+#include "../LIB/cpu_load.h"
+#include "../LIB/stack_check.h"
+#include "../MCAL/UART/UART.h"
+#include "calib.h"
+#include "clock.h"
+#include "eventlog.h"
+#include <util/crc16.h>
+
+#if TELEMETRY_ENABLED
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Period whose rate is sent as the refresh rate, in whole milliseconds */
+#if BOARD_HAS_SEVSEG
+#define TELEMETRY_FRAME_MS (SEVSEG_FRAME_US / 1000)
+#else
+#define TELEMETRY_FRAME_MS 1
+#endif
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static unsigned char telemetry_reset_cause;
+static unsigned char telemetry_sequence = 0;
+static unsigned long telemetry_due; // uptime of the next record
+static unsigned int telemetry_crc;
+
+/* Millisecond tick on the first pass after the last clock tick, and at the
+ * start of the refresh span (taken the same way) */
+static unsigned long telemetry_seen;
+static unsigned int telemetry_seen_ms;
+static unsigned long telemetry_mark;
+static unsigned int telemetry_mark_ms;
+static unsigned char telemetry_marked = 0;
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Start the telemetry.
+ * @param  reset_cause WDT_RESET_* flags of this boot.
+ * @return None
+ */
+void telemetry_vInit(unsigned char reset_cause) {
+  telemetry_reset_cause = reset_cause;
+  telemetry_seen = clock_u32uptime(); // no stamp until the next tick
+  telemetry_due = telemetry_seen + TELEMETRY_PERIOD_S;
+}
+
+/**
+ * @brief  Put a byte of the record and add it to its checksum.
+ * @param  data The byte.
+ * @return None
+ */
+static void telemetry_vput(unsigned char data) {
+  telemetry_crc = _crc_ccitt_update(telemetry_crc, data);
+  UART_vtx_put(data);
+}
+
+/**
+ * @brief  Put a 16-bit field, low byte first.
+ * @param  data The value.
+ * @return None
+ */
+static void telemetry_vput16(unsigned int data) {
+  telemetry_vput((unsigned char)data);
+  telemetry_vput((unsigned char)(data >> 8));
+}
+
+/**
+ * @brief  Put a 32-bit field, low byte first.
+ * @param  data The value.
+ * @return None
+ */
+static void telemetry_vput32(unsigned long data) {
+  telemetry_vput16((unsigned int)data);
+  telemetry_vput16((unsigned int)(data >> 16));
+}
+
+/**
+ * @brief  Refresh rate over the span since the last record, and start the
+ *         next span.
+ * @param  None
+ * @return The rate in 0.1Hz, 0 if there is no whole span yet.
+ */
+static unsigned int telemetry_u16refresh(void) {
+  unsigned long seconds = telemetry_seen - telemetry_mark;
+  unsigned int span_ms = telemetry_seen_ms - telemetry_mark_ms;
+  unsigned int rate = 0;
+
+  if (telemetry_marked && seconds != 0 && seconds <= 60) {
+    rate = (unsigned long)span_ms * 10 / (TELEMETRY_FRAME_MS * seconds);
+  }
+  telemetry_mark = telemetry_seen;
+  telemetry_mark_ms = telemetry_seen_ms;
+  return rate;
+}
+
+/**
+ * @brief  Send a record when one is due and the transmit buffer has room.
+ * @param  now_ms Current millisecond tick.
+ * @return None
+ */
+void telemetry_vtask(unsigned int now_ms) {
+  unsigned long uptime = clock_u32uptime();
+  unsigned int crc;
+
+  if (uptime != telemetry_seen) {
+    // first pass after a tick: the stamp is a few ms at most behind it
+    telemetry_seen = uptime;
+    telemetry_seen_ms = now_ms;
+    if (!telemetry_marked) {
+      telemetry_mark = uptime;
+      telemetry_mark_ms = now_ms;
+      telemetry_marked = 1;
+    }
+  }
+  if (uptime < telemetry_due) {
+    return;
+  }
+  // a dump frame must not be cut; a late record keeps its place otherwise
+  if (eventlog_u8dumping() || !UART_u8tx_begin(TELEMETRY_RECORD_SIZE)) {
+    return;
+  }
+  telemetry_due = uptime + TELEMETRY_PERIOD_S;
+
+  telemetry_crc = 0xFFFF;
+  telemetry_vput16(TELEMETRY_MAGIC);
+  telemetry_vput(TELEMETRY_VERSION);
+  telemetry_vput(telemetry_sequence++);
+  telemetry_vput32(clock_u32seconds());
+  telemetry_vput32(uptime);
+  telemetry_vput16((unsigned int)clock_s16get_trim());
+#if BOARD_HAS_PPS_INPUT
+  telemetry_vput(calib_u8state());
+#else
+  telemetry_vput(CALIB_IDLE);
+#endif
+  telemetry_vput(telemetry_reset_cause);
+  telemetry_vput16(cpu_load_u16busy());
+  telemetry_vput16(stack_u16headroom());
+  telemetry_vput16(telemetry_u16refresh());
+  telemetry_vput16(keypad_u16presses());
+  crc = telemetry_crc;
+  UART_vtx_put((unsigned char)crc);
+  UART_vtx_put((unsigned char)(crc >> 8));
+  UART_vtx_commit();
+}
+#endif /* TELEMETRY_ENABLED */
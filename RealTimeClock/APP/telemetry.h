@@ -0,0 +1,80 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: telemetry.h
+ * Description: Header file for the binary health telemetry on the UART
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "../LIB/board_pinmap.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* On by default on boards with a serial port, -DTELEMETRY_ENABLED=0 mutes */
+#ifndef TELEMETRY_ENABLED
+#define TELEMETRY_ENABLED BOARD_HAS_UART
+#endif
+#if TELEMETRY_ENABLED && !BOARD_HAS_UART
+#error "telemetry.h: the board has no serial port"
+#endif
+
+/* Clock seconds between records; the refresh span must fit the 65s
+ * millisecond tick */
+#ifndef TELEMETRY_PERIOD_S
+#define TELEMETRY_PERIOD_S 10
+#endif
+#if TELEMETRY_PERIOD_S < 1 || TELEMETRY_PERIOD_S > 60
+#error "telemetry.h: TELEMETRY_PERIOD_S must be 1-60"
+#endif
+
+/*
+ * Record, little endian, built straight in the UART transmit buffer:
+ *   0 magic (2)        TELEMETRY_MAGIC
+ *   2 version          TELEMETRY_VERSION
+ *   3 sequence         +1 per record, wraps; a gap is a lost record
+ *   4 time (4)         UTC seconds since 2000-01-01
+ *   8 uptime (4)       clock seconds since boot
+ *  12 trim (2, signed) crystal correction in 1/CLOCK_TRIM_SCALE ppm
+ *  14 calib state      CALIB_*, CALIB_IDLE without a 1PPS input
+ *  15 reset cause      WDT_RESET_* flags of the last reset
+ *  16 cpu load (2)     busy time in 0.1%
+ *  18 stack (2)        stack headroom in bytes
+ *  20 refresh (2)      refresh rate against the crystal in 0.1Hz, 0 for
+ *                      the first record: display frames on seven segment
+ *                      boards, the millisecond tick otherwise
+ *  22 keys (2)         key presses since boot, wraps
+ *  24 crc (2)          CRC-CCITT (seed 0xFFFF) of bytes 0-23
+ */
+#define TELEMETRY_MAGIC 0x54E5 // 0xE5 'T' on the wire
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_RECORD_SIZE 26
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+#if TELEMETRY_ENABLED
+/**
+ * @brief  Start the telemetry; the first record follows TELEMETRY_PERIOD_S
+ *         clock seconds later.
+ * @param  reset_cause WDT_RESET_* flags of this boot, sent in every record.
+ * @return None
+ */
+void telemetry_vInit(unsigned char reset_cause);
+
+/**
+ * @brief  Send a record when one is due and the transmit buffer has room
+ *         for all of it. Called from the run loop; never waits.
+ * @param  now_ms Current millisecond tick.
+ * @return None
+ */
+void telemetry_vtask(unsigned int now_ms);
+#endif
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,378 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: tz.c
+ * Description: Source file for the time zones and daylight saving rules
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "tz.h"
+#include "storage.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define TZ_MINUTES_PER_DAY 1440
+#define TZ_NO_SWITCH 0xFFFF // the state does not change during the day
+
+/* Daylight saving rules */
+#define TZ_RULE_EU 0
+#define TZ_RULE_US 1
+#define TZ_RULE_AU 2
+#define TZ_RULE_NONE 0xFF
+
+/* Week of the switch: nth Sunday of the month, or the last one */
+#define TZ_LAST_WEEK 5
+
+/* The switch hours of the rule are UTC, not local standard time. They must
+ * fall on the same local day in every zone using the rule. */
+#define TZ_RULE_UTC 0x01
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+typedef struct {
+  unsigned char start_month;
+  unsigned char start_week; /* nth Sunday, TZ_LAST_WEEK */
+  unsigned char start_hour; /* local standard time, or UTC */
+  unsigned char end_month;
+  unsigned char end_week;
+  unsigned char end_hour;
+  unsigned char flags; /* TZ_RULE_UTC */
+} tz_rule_t;
+
+typedef struct {
+  char name[TZ_NAME_SIZE];
+  signed char offset; /* standard offset from UTC in quarter hours */
+  unsigned char rule; /* TZ_RULE_* */
+} tz_zone_t;
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static const tz_rule_t tz_rules[] PROGMEM = {
+    {3, TZ_LAST_WEEK, 1, 10, TZ_LAST_WEEK, 1, TZ_RULE_UTC}, // TZ_RULE_EU
+    {3, 2, 2, 11, 1, 1, 0}, // TZ_RULE_US, ends 02:00 daylight time
+    {10, 1, 2, 4, 1, 2, 0}, // TZ_RULE_AU, ends 03:00 daylight time
+};
+
+static const tz_zone_t tz_zones[TZ_ZONES] PROGMEM = {
+    {"UTC", 0, TZ_RULE_NONE},   // TZ_UTC
+    {"LON", 0, TZ_RULE_EU},     // TZ_LONDON
+    {"BER", 4, TZ_RULE_EU},     // TZ_BERLIN, +1h
+    {"MOW", 12, TZ_RULE_NONE},  // TZ_MOSCOW, +3h
+    {"DXB", 16, TZ_RULE_NONE},  // TZ_DUBAI, +4h
+    {"DEL", 22, TZ_RULE_NONE},  // TZ_DELHI, +5:30
+    {"TYO", 36, TZ_RULE_NONE},  // TZ_TOKYO, +9h
+    {"SYD", 40, TZ_RULE_AU},    // TZ_SYDNEY, +10h
+    {"NYC", -20, TZ_RULE_US},   // TZ_NEW_YORK, -5h
+    {"LAX", -32, TZ_RULE_US},   // TZ_LOS_ANGELES, -8h
+};
+
+static unsigned char tz_world = TZ_HOME;
+
+/* Daylight saving of every zone for the UTC day in tz_day */
+static clock_date_t tz_day;
+static unsigned char tz_day_valid = 0;
+static unsigned int tz_dst_at_midnight; // one bit per zone
+static unsigned int tz_switch_minute[TZ_ZONES]; // UTC minute, TZ_NO_SWITCH
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Move a date one day forward or back.
+ * @param  date Pointer to the date, changed in place.
+ * @param  forward Non-zero for the next day, zero for the previous one.
+ * @return None
+ */
+static void tz_vstep_day(clock_date_t *date, unsigned char forward) {
+  if (forward) {
+    if (++date->day > clock_u8days_in_month(date->month, date->year)) {
+      date->day = 1;
+      if (++date->month > 12) {
+        date->month = 1;
+        date->year = (date->year == 99) ? 0 : date->year + 1;
+      }
+    }
+  } else if (--date->day == 0) {
+    if (--date->month == 0) {
+      date->month = 12;
+      date->year = (date->year == 0) ? 99 : date->year - 1;
+    }
+    date->day = clock_u8days_in_month(date->month, date->year);
+  }
+}
+
+/**
+ * @brief  Add a signed number of minutes to a time, carrying into the date.
+ * @param  time Pointer to the time, changed in place.
+ * @param  date Pointer to the date, changed in place.
+ * @param  minutes Less than one day either way.
+ * @return None
+ */
+static void tz_vshift(clock_time_t *time, clock_date_t *date,
+                      signed int minutes) {
+  signed int total = time->hours * 60 + time->minutes + minutes;
+
+  if (total < 0) {
+    total += TZ_MINUTES_PER_DAY;
+    tz_vstep_day(date, 0);
+  } else if (total >= TZ_MINUTES_PER_DAY) {
+    total -= TZ_MINUTES_PER_DAY;
+    tz_vstep_day(date, 1);
+  }
+  time->hours = total / 60;
+  time->minutes = total % 60;
+}
+
+/**
+ * @brief  Day of the week of a date.
+ * @param  year 0-99 for 2000-2099.
+ * @param  month 1-12.
+ * @param  day 1-31.
+ * @return 0 for Sunday to 6 for Saturday.
+ */
+static unsigned char tz_u8weekday(unsigned char year, unsigned char month,
+                                  unsigned char day) {
+  clock_date_t date;
+
+  date.year = year;
+  date.month = month;
+  date.day = day;
+  return (clock_u16day_number(&date) + 6) % 7; // day 0 was a Saturday
+}
+
+/**
+ * @brief  Day of the month of a switch Sunday.
+ * @param  year 0-99 for 2000-2099.
+ * @param  month 1-12.
+ * @param  week nth Sunday (1-4) or TZ_LAST_WEEK.
+ * @return 1-31.
+ */
+static unsigned char tz_u8sunday(unsigned char year, unsigned char month,
+                                 unsigned char week) {
+  unsigned char day = 1 + (7 - tz_u8weekday(year, month, 1)) % 7;
+
+  day += 7 * (week - 1);
+  if (day > clock_u8days_in_month(month, year)) {
+    day -= 7; // no fifth Sunday this month
+  }
+  return day;
+}
+
+/**
+ * @brief  Sortable key of an instant within a year.
+ * @param  month 1-12.
+ * @param  day 1-31.
+ * @param  minute Minute of the day, 0-1439.
+ * @return Key that orders like the instants.
+ */
+static unsigned long tz_u32key(unsigned char month, unsigned char day,
+                               unsigned int minute) {
+  return ((unsigned long)month << 16) | ((unsigned int)day << 11) | minute;
+}
+
+/**
+ * @brief  Minute of the local standard day at which a rule switches.
+ * @param  hour Switch hour of the rule.
+ * @param  flags Rule flags.
+ * @param  offset Standard offset of the zone in minutes.
+ * @return 0-1439.
+ */
+static unsigned int tz_u16switch_minute(unsigned char hour,
+                                        unsigned char flags,
+                                        signed int offset) {
+  signed int minute = hour * 60;
+  if (flags & TZ_RULE_UTC) {
+    minute += offset;
+  }
+  return (unsigned int)minute;
+}
+
+/**
+ * @brief  Evaluate a daylight saving rule at one instant.
+ * @param  zone Pointer to the zone (in RAM).
+ * @param  rule Pointer to the rule (in RAM).
+ * @param  date UTC date.
+ * @param  minute UTC minute of the day, 0-1439.
+ * @return 1 if daylight saving is on, 0 otherwise.
+ */
+static unsigned char tz_u8dst_at(const tz_zone_t *zone, const tz_rule_t *rule,
+                                 clock_date_t date, unsigned int minute) {
+  clock_time_t time;
+  signed int offset = zone->offset * 15;
+  unsigned long now, start, end;
+
+  // the rule dates are in local standard time
+  time.hours = minute / 60;
+  time.minutes = minute % 60;
+  tz_vshift(&time, &date, offset);
+  now = tz_u32key(date.month, date.day, time.hours * 60 + time.minutes);
+  start = tz_u32key(rule->start_month,
+                    tz_u8sunday(date.year, rule->start_month,
+                                rule->start_week),
+                    tz_u16switch_minute(rule->start_hour, rule->flags,
+                                        offset));
+  end = tz_u32key(rule->end_month,
+                  tz_u8sunday(date.year, rule->end_month, rule->end_week),
+                  tz_u16switch_minute(rule->end_hour, rule->flags, offset));
+  if (rule->start_month < rule->end_month) {
+    return now >= start && now < end;
+  }
+  return now >= start || now < end; // southern hemisphere, across new year
+}
+
+/**
+ * @brief  Work out the daylight saving state of every zone for a UTC day.
+ * @param  date UTC date.
+ * @return None
+ */
+static void tz_vrefresh(const clock_date_t *date) {
+  tz_zone_t zone;
+  tz_rule_t rule;
+  unsigned char i;
+  unsigned char at_midnight, at_end;
+  signed int minute;
+
+  tz_dst_at_midnight = 0;
+  for (i = 0; i < TZ_ZONES; i++) {
+    tz_switch_minute[i] = TZ_NO_SWITCH;
+    memcpy_P(&zone, &tz_zones[i], sizeof(zone));
+    if (zone.rule == TZ_RULE_NONE) {
+      continue;
+    }
+    memcpy_P(&rule, &tz_rules[zone.rule], sizeof(rule));
+    at_midnight = tz_u8dst_at(&zone, &rule, *date, 0);
+    at_end = tz_u8dst_at(&zone, &rule, *date, TZ_MINUTES_PER_DAY - 1);
+    if (at_midnight) {
+      tz_dst_at_midnight |= 1U << i;
+    }
+    if (at_midnight != at_end) {
+      // a rule switches at most once a day, at a fixed UTC minute
+      minute = tz_u16switch_minute(at_end ? rule.start_hour : rule.end_hour,
+                                   rule.flags, zone.offset * 15);
+      minute -= zone.offset * 15;
+      if (minute < 0) {
+        minute += TZ_MINUTES_PER_DAY;
+      } else if (minute >= TZ_MINUTES_PER_DAY) {
+        minute -= TZ_MINUTES_PER_DAY;
+      }
+      tz_switch_minute[i] = minute;
+    }
+  }
+  tz_day = *date;
+  tz_day_valid = 1;
+}
+
+/**
+ * @brief  Offset of a zone from UTC at a given instant.
+ * @param  zone TZ_* zone.
+ * @param  time UTC time.
+ * @param  date UTC date.
+ * @return Offset in minutes, daylight saving included.
+ */
+static signed int tz_s16offset(unsigned char zone, const clock_time_t *time,
+                               const clock_date_t *date) {
+  unsigned char dst;
+  unsigned int minute = time->hours * 60 + time->minutes;
+
+  if (!tz_day_valid || tz_day.day != date->day ||
+      tz_day.month != date->month || tz_day.year != date->year) {
+    tz_vrefresh(date); // first call of a new UTC day
+  }
+  dst = (tz_dst_at_midnight >> zone) & 1;
+  if (minute >= tz_switch_minute[zone]) {
+    dst ^= 1;
+  }
+  return (signed char)pgm_read_byte(&tz_zones[zone].offset) * 15 +
+         (dst ? 60 : 0);
+}
+
+/**
+ * @brief  Restore the zone shown on the LCD from the last EEPROM record.
+ * @param  None
+ * @return None
+ */
+void tz_vInit(void) {
+  storage_record_t record;
+
+  if (storage_u8load(&record) && record.zone < TZ_ZONES) {
+    tz_world = record.zone;
+  }
+}
+
+/**
+ * @brief  Convert a UTC time and date to the local time of a zone.
+ * @param  zone TZ_* zone.
+ * @param  time Pointer to the time, converted in place.
+ * @param  date Pointer to the date, converted in place.
+ * @return None
+ */
+void tz_vlocal(unsigned char zone, clock_time_t *time, clock_date_t *date) {
+  tz_vshift(time, date, tz_s16offset(zone, time, date));
+}
+
+/**
+ * @brief  Get the local time of a zone now.
+ * @param  zone TZ_* zone.
+ * @param  time Pointer to store the time (24h form).
+ * @param  date Pointer to store the date.
+ * @return None
+ */
+void tz_vget_local(unsigned char zone, clock_time_t *time,
+                   clock_date_t *date) {
+  clock_vGet_date(time, date);
+  tz_vlocal(zone, time, date);
+}
+
+/**
+ * @brief  Set the clock from a time of day in TZ_HOME, keeping the current
+ *         local date. The offset in effect now is used.
+ * @param  time Pointer to the local time (24h form).
+ * @return None
+ */
+void tz_vset_local(const clock_time_t *time) {
+  clock_time_t now;
+  clock_date_t date;
+  signed int offset;
+
+  clock_vGet_date(&now, &date);
+  offset = tz_s16offset(TZ_HOME, &now, &date);
+  tz_vshift(&now, &date, offset); // today's local date
+  now = *time;
+  tz_vshift(&now, &date, -offset);
+  clock_vSet(&now);
+  clock_vSet_date(&date);
+}
+
+/**
+ * @brief  Write the short name of a zone, e.g. "NYC".
+ * @param  zone TZ_* zone.
+ * @param  text Buffer of TZ_NAME_SIZE characters.
+ * @return None
+ */
+void tz_vzone_name(unsigned char zone, char *text) {
+  strcpy_P(text, tz_zones[zone].name);
+}
+
+/**
+ * @brief  Zone shown on the LCD.
+ * @param  None
+ * @return TZ_* zone, TZ_HOME when no other zone is selected.
+ */
+unsigned char tz_u8get_world(void) { return tz_world; }
+
+/**
+ * @brief  Select the next zone for the LCD, wrapping after the last one.
+ * @param  None
+ * @return None
+ */
+void tz_vnext_world(void) {
+  tz_world = (tz_world + 1 < TZ_ZONES) ? tz_world + 1 : 0;
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+ * Module: APP
+ * File Name: tz.h
+ * Description: Header file for the time zones and daylight saving rules
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef TZ_H_
+#define TZ_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "clock.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * The clock core counts UTC. Each zone is a flash entry of a standard offset
+ * and a daylight saving rule; local time is UTC plus the offset, plus one
+ * hour while daylight saving is on. The daylight saving state of every zone
+ * is worked out once per UTC day (the state at 00:00 and the minute it
+ * changes, if it changes that day), so converting a time costs a compare and
+ * an add.
+ */
+#define TZ_UTC 0
+#define TZ_LONDON 1
+#define TZ_BERLIN 2
+#define TZ_MOSCOW 3
+#define TZ_DUBAI 4
+#define TZ_DELHI 5
+#define TZ_TOKYO 6
+#define TZ_SYDNEY 7
+#define TZ_NEW_YORK 8
+#define TZ_LOS_ANGELES 9
+#define TZ_ZONES 10
+
+/* Zone of the seven segment display and the LCD time */
+#ifndef TZ_HOME
+#define TZ_HOME TZ_UTC
+#endif
+
+/* Zone name buffer size, terminating null included */
+#define TZ_NAME_SIZE 4
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Restore the zone shown on the LCD from the last EEPROM record.
+ * @param  None
+ * @return None
+ */
+void tz_vInit(void);
+
+/**
+ * @brief  Convert a UTC time and date to the local time of a zone.
+ * @param  zone TZ_* zone.
+ * @param  time Pointer to the time, converted in place.
+ * @param  date Pointer to the date, converted in place.
+ * @return None
+ */
+void tz_vlocal(unsigned char zone, clock_time_t *time, clock_date_t *date);
+
+/**
+ * @brief  Get the local time of a zone now.
+ * @param  zone TZ_* zone.
+ * @param  time Pointer to store the time (24h form).
+ * @param  date Pointer to store the date.
+ * @return None
+ */
+void tz_vget_local(unsigned char zone, clock_time_t *time, clock_date_t *date);
+
+/**
+ * @brief  Set the clock from a time of day in TZ_HOME, keeping the current
+ *         local date. The offset in effect now is used.
+ * @param  time Pointer to the local time (24h form).
+ * @return None
+ */
+void tz_vset_local(const clock_time_t *time);
+
+/**
+ * @brief  Write the short name of a zone, e.g. "NYC".
+ * @param  zone TZ_* zone.
+ * @param  text Buffer of TZ_NAME_SIZE characters.
+ * @return None
+ */
+void tz_vzone_name(unsigned char zone, char *text);
+
+/**
+ * @brief  Zone shown on the LCD.
+ * @param  None
+ * @return TZ_* zone, TZ_HOME when no other zone is selected.
+ */
+unsigned char tz_u8get_world(void);
+
+/**
+ * @brief  Select the next zone for the LCD, wrapping after the last one.
+ * @param  None
+ * @return None
+ */
+void tz_vnext_world(void);
+
+#endif /* TZ_H_ */
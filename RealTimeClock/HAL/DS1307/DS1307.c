@@ -0,0 +1,128 @@
+/******************************************************************************
+ * Module: HAL
+ * File Name: DS1307.c
+ * Description: Source file for the DS1307/DS3231 RTC chip driver
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "DS1307.h"
+#include "../../LIB/rtc_format.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define DS1307_CLOCK_HALT 0x80 // seconds register, DS1307 only
+#define DS1307_HOURS_12H 0x40  // hours register: 12h mode
+#define DS1307_HOURS_PM 0x20   // hours register in 12h mode
+#define DS1307_CENTURY 0x80    // month register, DS3231 only
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static twi_transaction_t ds1307_transfer = {.status = TWI_DONE};
+static const unsigned char ds1307_first_register = 0;
+static unsigned char ds1307_registers[DS1307_TIME_REGISTERS];
+static unsigned char ds1307_write_buffer[1 + DS1307_TIME_REGISTERS];
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Binary value of a packed BCD byte.
+ * @param  bcd The BCD byte.
+ * @param  max Largest valid value.
+ * @return 0-99, or 0xFF if a nibble is not a digit or the value is above max.
+ */
+static unsigned char ds1307_u8from_bcd(unsigned char bcd, unsigned char max) {
+  unsigned char value;
+  if ((bcd & 0x0F) > 9 || (bcd >> 4) > 9) {
+    return 0xFF;
+  }
+  value = (bcd >> 4) * 10 + (bcd & 0x0F);
+  return (value > max) ? 0xFF : value;
+}
+
+/**
+ * @brief  Queue a read of the time registers.
+ * @param  None
+ * @return 1 if queued, 0 if the last transfer is still pending or the TWI
+ *         queue is full.
+ */
+unsigned char DS1307_u8start_read(void) {
+  if (ds1307_transfer.status == TWI_PENDING) {
+    return 0;
+  }
+  ds1307_transfer.address = DS1307_ADDRESS;
+  ds1307_transfer.tx = &ds1307_first_register;
+  ds1307_transfer.tx_length = 1;
+  ds1307_transfer.rx = ds1307_registers;
+  ds1307_transfer.rx_length = DS1307_TIME_REGISTERS;
+  return TWI_u8submit(&ds1307_transfer);
+}
+
+/**
+ * @brief  Queue a write of the time registers.
+ * @param  time Pointer to the time to write.
+ * @return 1 if queued, 0 if the last transfer is still pending or the TWI
+ *         queue is full.
+ */
+unsigned char DS1307_u8start_write(const ds1307_time_t *time) {
+  if (ds1307_transfer.status == TWI_PENDING) {
+    return 0;
+  }
+  ds1307_write_buffer[0] = ds1307_first_register;
+  ds1307_write_buffer[1] = rtc_format_u8bcd(time->seconds); // CH = 0
+  ds1307_write_buffer[2] = rtc_format_u8bcd(time->minutes);
+  ds1307_write_buffer[3] = rtc_format_u8bcd(time->hours); // 24h mode
+  ds1307_write_buffer[4] = time->weekday;
+  ds1307_write_buffer[5] = rtc_format_u8bcd(time->day);
+  ds1307_write_buffer[6] = rtc_format_u8bcd(time->month);
+  ds1307_write_buffer[7] = rtc_format_u8bcd(time->year);
+  ds1307_transfer.address = DS1307_ADDRESS;
+  ds1307_transfer.tx = ds1307_write_buffer;
+  ds1307_transfer.tx_length = sizeof(ds1307_write_buffer);
+  ds1307_transfer.rx_length = 0;
+  return TWI_u8submit(&ds1307_transfer);
+}
+
+/**
+ * @brief  State of the last read or write.
+ * @param  None
+ * @return TWI_PENDING, TWI_DONE, TWI_NACK (no chip) or TWI_ERROR.
+ */
+unsigned char DS1307_u8status(void) { return ds1307_transfer.status; }
+
+/**
+ * @brief  Decode the registers of the last finished read.
+ * @param  time Pointer to store the time (24h form).
+ * @return 1 if the chip was running and holds a valid time, 0 otherwise.
+ */
+unsigned char DS1307_u8get(ds1307_time_t *time) {
+  unsigned char hours = ds1307_registers[2];
+
+  if (ds1307_registers[0] & DS1307_CLOCK_HALT) {
+    return 0; // never set since the battery went in
+  }
+  time->seconds = ds1307_u8from_bcd(ds1307_registers[0], 59);
+  time->minutes = ds1307_u8from_bcd(ds1307_registers[1], 59);
+  if (hours & DS1307_HOURS_12H) { // set by another master, 12 is midnight
+    time->hours = ds1307_u8from_bcd(hours & 0x1F, 12);
+    if (time->hours != 0xFF) {
+      time->hours = time->hours % 12 + ((hours & DS1307_HOURS_PM) ? 12 : 0);
+    }
+  } else {
+    time->hours = ds1307_u8from_bcd(hours & 0x3F, 23);
+  }
+  time->weekday = ds1307_registers[3] & 0x07;
+  time->day = ds1307_u8from_bcd(ds1307_registers[4], 31);
+  time->month = ds1307_u8from_bcd(ds1307_registers[5] & ~DS1307_CENTURY, 12);
+  time->year = ds1307_u8from_bcd(ds1307_registers[6], 99);
+  return time->seconds != 0xFF && time->minutes != 0xFF &&
+         time->hours != 0xFF && time->day != 0xFF && time->day != 0 &&
+         time->month != 0xFF && time->month != 0 && time->year != 0xFF;
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+ * Module: HAL
+ * File Name: DS1307.h
+ * Description: Header file for the DS1307/DS3231 RTC chip driver
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef DS1307_H_
+#define DS1307_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "../../MCAL/TWI/TWI.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Both chips answer at this address and keep the time in registers 0-6
+ * (seconds, minutes, hours, weekday, day, month, year) as packed BCD */
+#define DS1307_ADDRESS 0x68
+#define DS1307_TIME_REGISTERS 7
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+/* Time and date as the chip keeps it, in binary */
+typedef struct {
+  unsigned char seconds;
+  unsigned char minutes;
+  unsigned char hours;   /* 0-23 */
+  unsigned char weekday; /* 1-7, 1 = Sunday */
+  unsigned char day;     /* 1-31 */
+  unsigned char month;   /* 1-12 */
+  unsigned char year;    /* 0-99 for 2000-2099 */
+} ds1307_time_t;
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Queue a read of the time registers. The result is taken with
+ *         DS1307_u8get() once DS1307_u8status() is TWI_DONE.
+ * @param  None
+ * @return 1 if queued, 0 if the last transfer is still pending or the TWI
+ *         queue is full.
+ */
+unsigned char DS1307_u8start_read(void);
+
+/**
+ * @brief  Queue a write of the time registers. The time is copied, so the
+ *         caller may reuse it at once. Writing also starts a halted DS1307
+ *         oscillator and selects the 24h mode.
+ * @param  time Pointer to the time to write.
+ * @return 1 if queued, 0 if the last transfer is still pending or the TWI
+ *         queue is full.
+ */
+unsigned char DS1307_u8start_write(const ds1307_time_t *time);
+
+/**
+ * @brief  State of the last read or write.
+ * @param  None
+ * @return TWI_PENDING, TWI_DONE, TWI_NACK (no chip) or TWI_ERROR.
+ */
+unsigned char DS1307_u8status(void);
+
+/**
+ * @brief  Decode the registers of the last finished read.
+ * @param  time Pointer to store the time (24h form).
+ * @return 1 if the chip was running and holds a valid time, 0 if its
+ *         oscillator was halted (new battery) or a register is out of range.
+ */
+unsigned char DS1307_u8get(ds1307_time_t *time);
+
+#endif /* DS1307_H_ */
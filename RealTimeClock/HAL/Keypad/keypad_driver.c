@@ -10,6 +10,27 @@
  *                                  Includes                                   *
  *******************************************************************************/
 #include "keypad_driver.h"
+#include "../../MCAL/DIO/DIO.h"
+#include <avr/cpufunc.h>
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+/* Key of each bitmap bit, bit = row * 4 + column */
+static const char keypad_keys[KEYPAD_KEYS] = {'7', '8', '9', '/',
+                                              '4', '5', '6', '*',
+                                              '1', '2', '3', '-',
+                                              'A', '0', '=', '+'};
+
+/* Debounced bitmap, see keypad_u8get_key() */
+static unsigned int keypad_held = 0;
+static unsigned int keypad_presses = 0; // wraps
+
+/* Long press and auto-repeat of the last pressed key */
+static unsigned int keypad_repeat_bit = 0; // 0 when no key repeats
+static unsigned int keypad_repeat_since;
+static unsigned int keypad_repeat_wait;
+static unsigned char keypad_repeat_long;   // long press already reported
 
 /*******************************************************************************
  *                             Functions Definitions                           *
@@ -21,18 +42,68 @@
  * @return None
  */
 void keypad_vInit() {
-  DIO_vsetPINDir('D', 0, 1);
-  DIO_vsetPINDir('D', 1, 1);
-  DIO_vsetPINDir('D', 2, 1);
-  DIO_vsetPINDir('D', 3, 1);
-  DIO_vsetPINDir('D', 4, 0);
-  DIO_vsetPINDir('D', 5, 0);
-  DIO_vsetPINDir('D', 6, 0);
-  DIO_vsetPINDir('D', 7, 0);
-  DIO_vconnectpullup('D', 4, 1);
-  DIO_vconnectpullup('D', 5, 1);
-  DIO_vconnectpullup('D', 6, 1);
-  DIO_vconnectpullup('D', 7, 1);
+  DIO_REG_WRITE_MASK(KEYPAD_ROW_DDR, KEYPAD_ROW_MASK, 0xFF);  // rows out
+  DIO_REG_WRITE_MASK(KEYPAD_COL_DDR, KEYPAD_COL_MASK, 0x00);  // columns in
+  DIO_REG_WRITE_MASK(KEYPAD_COL_PORT, KEYPAD_COL_MASK, 0xFF); // pull-ups
+}
+
+/**
+ * @brief  Scan the whole matrix: one port write and one pin read per row.
+ * @param  None
+ * @return Bitmap of the pressed keys, bit (row * 4 + column) set if pressed.
+ */
+unsigned int keypad_u16scan(void) {
+  unsigned int keys = 0;
+  unsigned char row = 4;
+  unsigned char columns;
+
+  PROFILE_BEGIN(PROF_KEYPAD_SCAN);
+  // last row first, so each row's nibble ends at bit row * 4
+  while (row > 0) {
+    row--;
+    DIO_REG_WRITE_MASK(KEYPAD_ROW_PORT, KEYPAD_ROW_MASK,
+                       ~(1 << (KEYPAD_ROW_FIRST + row)));
+    _NOP(); // let the row level pass the input synchronizer
+    columns = DIO_REG_READ_MASK((unsigned char)~KEYPAD_COL_PIN,
+                                KEYPAD_COL_MASK); // pressed keys read low
+    keys = (keys << 4) | (columns >> KEYPAD_COL_FIRST);
+  }
+  DIO_REG_WRITE_MASK(KEYPAD_ROW_PORT, KEYPAD_ROW_MASK, 0xFF);
+  PROFILE_END(PROF_KEYPAD_SCAN);
+  return keys;
+}
+
+/**
+ * @brief  Bitmap bit of a key, to build combos for keypad_u16scan().
+ * @param  key Key character as in the keymap.
+ * @return The key's bit, 0 if the key is not on the keypad.
+ */
+unsigned int keypad_u16key_mask(char key) {
+  unsigned char i;
+  for (i = 0; i < KEYPAD_KEYS; i++) {
+    if (keypad_keys[i] == key) {
+      return 1U << i;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief  First key of a bitmap in scan order.
+ * @param  keys Bitmap of keys.
+ * @return The key value or NOTPRESSED if the bitmap is empty.
+ */
+static char keypad_u8first_key(unsigned int keys) {
+  unsigned char i = 0;
+
+  if (keys == 0) {
+    return NOTPRESSED;
+  }
+  while (!(keys & 1)) {
+    keys >>= 1;
+    i++;
+  }
+  return keypad_keys[i];
 }
 
 /**
@@ -40,30 +111,75 @@ void keypad_vInit() {
  * @param  None
  * @return The pressed key value or NOTPRESSED if no key is pressed.
  */
-char keypad_u8check_press() {
-  char arr[4][4] = {{'7', '8', '9', '/'},
-                    {'4', '5', '6', '*'},
-                    {'1', '2', '3', '-'},
-                    {'A', '0', '=', '+'}};
-  char row, coloumn, x;
-  char returnval = NOTPRESSED;
-  for (row = 0; row < 4; row++) {
-    DIO_write('D', 0, 1);
-    DIO_write('D', 1, 1);
-    DIO_write('D', 2, 1);
-    DIO_write('D', 3, 1);
-    DIO_write('D', row, 0);
-
-    for (coloumn = 0; coloumn < 4; coloumn++) {
-      x = DIO_u8read('D', (coloumn + 4));
-      if (x == 0) {
-        returnval = arr[row][coloumn];
-        break;
-      }
+char keypad_u8check_press() { return keypad_u8first_key(keypad_u16scan()); }
+
+/**
+ * @brief  Debounced key event, for polling from the main loop. A key
+ *         pressed while others are held is reported too; the last pressed
+ *         key reports a long press and then auto-repeats while held.
+ * @param  now_ms Free-running millisecond tick of the caller.
+ * @param  event Pointer to store the KEYPAD_EVENT_* of the returned key.
+ * @return The key of the event, NOTPRESSED if there is none.
+ */
+char keypad_u8get_key(unsigned int now_ms, unsigned char *event) {
+  static unsigned int candidate = 0;
+  static unsigned int since = 0;
+  unsigned int keys = keypad_u16scan();
+  unsigned int pressed;
+
+  if (keys != candidate) {
+    if (keys & ~candidate & ~keypad_held) {
+      LATENCY_BEGIN(); // a key went down
     }
-    if (x == 0) {
-      break;
+    candidate = keys;
+    since = now_ms;
+  } else if (candidate != keypad_held &&
+             (unsigned int)(now_ms - since) >= KEYPAD_DEBOUNCE_MS) {
+    pressed = candidate & ~keypad_held; // keys that went down
+    keypad_held = candidate;
+    if (pressed) {
+      keypad_repeat_bit = pressed & (~pressed + 1); // first one in scan order
+      keypad_repeat_since = now_ms;
+      keypad_repeat_wait = KEYPAD_LONG_PRESS_MS;
+      keypad_repeat_long = 0;
+      *event = KEYPAD_EVENT_PRESS;
+      LATENCY_STAMP(LATENCY_EVENT, LATENCY_SRC_KEYPAD);
+      keypad_presses++;
+      return keypad_u8first_key(pressed);
     }
   }
-  return returnval;
-}
\ No newline at end of file
+
+  if (!(keypad_held & keypad_repeat_bit)) {
+    keypad_repeat_bit = 0; // released
+  } else if ((unsigned int)(now_ms - keypad_repeat_since) >=
+             keypad_repeat_wait) {
+    keypad_repeat_since = now_ms;
+    if (!keypad_repeat_long) {
+      keypad_repeat_long = 1;
+      keypad_repeat_wait = KEYPAD_REPEAT_START_MS;
+      *event = KEYPAD_EVENT_LONG;
+    } else {
+      keypad_repeat_wait -= keypad_repeat_wait / 4;
+      if (keypad_repeat_wait < KEYPAD_REPEAT_MIN_MS) {
+        keypad_repeat_wait = KEYPAD_REPEAT_MIN_MS;
+      }
+      *event = KEYPAD_EVENT_REPEAT;
+    }
+    return keypad_u8first_key(keypad_repeat_bit);
+  }
+  return NOTPRESSED;
+}
+
+/**
+ * @brief  Debounced bitmap of the keys held down, to test combos.
+ * @param  None
+ * @return Bitmap as in keypad_u16scan(), updated by keypad_u8get_key().
+ */
+unsigned int keypad_u16held(void) { return keypad_held; }
+
+/**
+ * @brief  Number of key presses reported since boot.
+ * @param  None
+ * @return The count, wrapping at 65536.
+ */
+unsigned int keypad_u16presses(void) { return keypad_presses; }
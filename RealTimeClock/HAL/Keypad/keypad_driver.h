@@ -12,13 +12,34 @@
 /*******************************************************************************
  *                                  Includes                                   *
  *******************************************************************************/
-#include "../../MCAL/DIO/DIO.h"
+#include "../../LIB/board_pinmap.h"
+#include "../../LIB/latency.h"
+#include "../../LIB/profiler.h"
+#include "../../LIB/std_macros.h"
 
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
 #define NOTPRESSED 0xff
 
+/* 4x4 matrix, one bit per key in the scan bitmap */
+#define KEYPAD_KEYS 16
+
+/* A key must read the same for this long before it is reported */
+#define KEYPAD_DEBOUNCE_MS 20
+
+/* Events reported by keypad_u8get_key() */
+#define KEYPAD_EVENT_PRESS 0  // key went down
+#define KEYPAD_EVENT_LONG 1   // held for KEYPAD_LONG_PRESS_MS
+#define KEYPAD_EVENT_REPEAT 2 // still held, auto-repeat
+
+/* Auto-repeat: after a long press the key repeats, starting every
+ * KEYPAD_REPEAT_START_MS; each repeat shortens the period by a quarter down
+ * to KEYPAD_REPEAT_MIN_MS (200, 150, 113, 85, 64, 48, 40ms ...) */
+#define KEYPAD_LONG_PRESS_MS 500
+#define KEYPAD_REPEAT_START_MS 200
+#define KEYPAD_REPEAT_MIN_MS 40
+
 /*******************************************************************************
  *                       Software Interfaces Declarations                      *
  *******************************************************************************/
@@ -30,6 +51,22 @@
  */
 void keypad_vInit();
 
+/**
+ * @brief  Scan the whole matrix: one port write and one pin read per row.
+ *         Any two keys are reported; three keys on the corners of a
+ *         rectangle also show the fourth (no diodes in the matrix).
+ * @param  None
+ * @return Bitmap of the pressed keys, bit (row * 4 + column) set if pressed.
+ */
+unsigned int keypad_u16scan(void);
+
+/**
+ * @brief  Bitmap bit of a key, to build combos for keypad_u16scan().
+ * @param  key Key character as in the keymap.
+ * @return The key's bit, 0 if the key is not on the keypad.
+ */
+unsigned int keypad_u16key_mask(char key);
+
 /**
  * @brief  Check for key press.
  * @param  None
@@ -37,4 +74,28 @@ void keypad_vInit();
  */
 char keypad_u8check_press();
 
+/**
+ * @brief  Debounced key event, for polling from the main loop. A key
+ *         pressed while others are held is reported too; the last pressed
+ *         key reports a long press and then auto-repeats while held.
+ * @param  now_ms Free-running millisecond tick of the caller.
+ * @param  event Pointer to store the KEYPAD_EVENT_* of the returned key.
+ * @return The key of the event, NOTPRESSED if there is none.
+ */
+char keypad_u8get_key(unsigned int now_ms, unsigned char *event);
+
+/**
+ * @brief  Debounced bitmap of the keys held down, to test combos.
+ * @param  None
+ * @return Bitmap as in keypad_u16scan(), updated by keypad_u8get_key().
+ */
+unsigned int keypad_u16held(void);
+
+/**
+ * @brief  Number of key presses reported since boot (not the repeats).
+ * @param  None
+ * @return The count, wrapping at 65536.
+ */
+unsigned int keypad_u16presses(void);
+
 #endif /* KEYPAD_DRIVER_H_ */
\ No newline at end of file
@@ -10,6 +10,7 @@
  *                                  Includes                                   *
  *******************************************************************************/
 #include "LCD.h"
+#include "../../MCAL/DIO/DIO.h"
 #define F_CPU 8000000UL
 #include <util/delay.h>
 
@@ -23,105 +24,187 @@
  * @return None
  */
 static void send_falling_edge(void) {
-  DIO_write('A', EN, 1);
-  _delay_ms(2);
-  DIO_write('A', EN, 0);
-  _delay_ms(2);
+  SET_BIT(LCD_CTRL_PORT, LCD_EN);
+  _delay_us(1); // EN high >= 450ns
+  CLR_BIT(LCD_CTRL_PORT, LCD_EN);
+  _delay_us(1);
 }
 
+#if defined four_bits_mode
 /**
- * @brief  Initialize the LCD driver.
- * @param  None
+ * @brief  Put a nibble on the D4-D7 data lines.
+ * @param  nibble The value to write (lower 4 bits).
  * @return None
  */
-void LCD_vInit(void) {
-  _delay_ms(200);
-#if defined eight_bits_mode
-  DIO_vsetPINDir('A', 0, 1);
-  DIO_vsetPINDir('A', 1, 1);
-  DIO_vsetPINDir('A', 2, 1);
-  DIO_vsetPINDir('A', 3, 1);
-  DIO_vsetPINDir('A', 4, 1);
-  DIO_vsetPINDir('A', 5, 1);
-  DIO_vsetPINDir('A', 6, 1);
-  DIO_vsetPINDir('A', 7, 1);
-  DIO_vsetPINDir('B', EN, 1);
-  DIO_vsetPINDir('B', RW, 1);
-  DIO_vsetPINDir('B', RS, 1);
-  DIO_write('B', RW, 0);
-  LCD_vSend_cmd(EIGHT_BITS); // 8 bit mode
-  _delay_ms(1);
-  LCD_vSend_cmd(CURSOR_ON_DISPLAN_ON); // display on cursor on
-  _delay_ms(1);
-  LCD_vSend_cmd(CLR_SCREEN); // clear the screen
-  _delay_ms(10);
-  LCD_vSend_cmd(ENTRY_MODE); // entry mode
-  _delay_ms(1);
-
-#elif defined four_bits_mode
-  DIO_vsetPINDir('A', 4, 1);
-  DIO_vsetPINDir('A', 5, 1);
-  DIO_vsetPINDir('A', 6, 1);
-  DIO_vsetPINDir('A', 7, 1);
-  DIO_vsetPINDir('A', EN, 1);
-  DIO_vsetPINDir('A', RW, 1);
-  DIO_vsetPINDir('A', RS, 1);
-  DIO_write('A', RW, 0);
-  LCD_vSend_cmd(RETURN_HOME); // return home
-  _delay_ms(10);
-  LCD_vSend_cmd(FOUR_BITS); // 4bit mode
-  _delay_ms(1);
-  LCD_vSend_cmd(CURSOR_ON_DISPLAN_ON); // display on cursor on
-  _delay_ms(1);
-  LCD_vSend_cmd(CLR_SCREEN); // clear the screen
-  _delay_ms(10);
-  LCD_vSend_cmd(ENTRY_MODE); // entry mode
-  _delay_ms(1);
+static void write_data_nibble(unsigned char nibble) {
+  DIO_REG_WRITE_MASK(LCD_DATA_PORT, LCD_DATA_MASK, nibble << LCD_DATA_FIRST);
+}
 #endif
+
+#if defined four_bits_mode && LCD_CTRL_ON_DATA_PORT
+/**
+ * @brief  Send one byte over a 4-bit bus that shares its port with EN/RW/RS.
+ *         Each nibble is composed with RS and EN into ready port values, so
+ *         the whole transfer is one port read and five port writes:
+ *         RS setup, EN rise with high nibble, EN fall (latch), EN rise with
+ *         low nibble, EN fall (latch). Counted from the sequence at 8MHz this
+ *         is ~20 cycles of composition plus 2 x 1us EN high time, against
+ *         four DIO read-modify-writes and 2 x 4ms of EN delays before.
+ *         Interrupts are held off from the port read to the last write
+ *         (~2.5us), so an ISR writing other pins of the port is not undone.
+ * @param  byte The command or character.
+ * @param  rs 0 for a command, 1 for data.
+ * @return None
+ */
+static void send_byte(unsigned char byte, unsigned char rs) {
+  unsigned char base, high, low;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    base = LCD_CTRL_PORT &
+           ~(LCD_DATA_MASK | (1 << LCD_EN) | (1 << LCD_RW) | (1 << LCD_RS));
+    if (rs) {
+      base |= (1 << LCD_RS);
+    }
+    high = base | (((byte >> 4) << LCD_DATA_FIRST) & LCD_DATA_MASK);
+    low = base | ((byte << LCD_DATA_FIRST) & LCD_DATA_MASK);
+
+    LCD_CTRL_PORT = high; // RS/RW settle before EN rises (tAS)
+    LCD_CTRL_PORT = high | (1 << LCD_EN);
+    _delay_us(1); // EN high >= 450ns
+    LCD_CTRL_PORT = high;
+    LCD_CTRL_PORT = low | (1 << LCD_EN);
+    _delay_us(1);
+    LCD_CTRL_PORT = low;
+  }
 }
 
+#else
 /**
- * @brief  Send a command to the LCD.
- * @param  cmd The command to send.
+ * @brief  Send one byte when data and control lines are on separate ports.
+ * @param  byte The command or character.
+ * @param  rs 0 for a command, 1 for data.
  * @return None
  */
-void LCD_vSend_cmd(char cmd) {
+static void send_byte(unsigned char byte, unsigned char rs) {
+  if (rs) {
+    SET_BIT(LCD_CTRL_PORT, LCD_RS);
+  } else {
+    CLR_BIT(LCD_CTRL_PORT, LCD_RS);
+  }
 #if defined eight_bits_mode
-  DIO_write_port('A', cmd);
-  DIO_write('B', RS, 0);
+  DIO_REG_WRITE_MASK(LCD_DATA_PORT, LCD_DATA_MASK, byte << LCD_DATA_FIRST);
   send_falling_edge();
-
 #elif defined four_bits_mode
-  write_high_nibble('A', cmd >> 4);
-  DIO_write('A', RS, 0);
+  write_data_nibble(byte >> 4);
   send_falling_edge();
-  write_high_nibble('A', cmd);
-  DIO_write('A', RS, 0);
+  write_data_nibble(byte);
   send_falling_edge();
 #endif
-  _delay_ms(1);
 }
+#endif
 
 /**
- * @brief  Send a character to the LCD.
- * @param  data The character to send.
+ * @brief  Poll the busy flag (D7) until the LCD can take the next transfer.
+ *         The poll is bounded so a missing display cannot hang the caller.
+ * @param  None
  * @return None
  */
-void LCD_vSend_char(char data) {
+static void wait_ready(void) {
+  unsigned char busy;
+  unsigned int tries = LCD_BUSY_TRIES;
+
+  DIO_REG_WRITE_MASK(LCD_DATA_DDR, LCD_DATA_MASK, 0x00); // release the bus
+  DIO_REG_WRITE_MASK(LCD_DATA_PORT, LCD_DATA_MASK, 0x00); // no pull-ups
+  CLR_BIT(LCD_CTRL_PORT, LCD_RS);
+  SET_BIT(LCD_CTRL_PORT, LCD_RW);
+  do {
+    SET_BIT(LCD_CTRL_PORT, LCD_EN);
+    _delay_us(1); // data valid after tDDR (360ns)
+    busy = READ_BIT(LCD_DATA_PIN, LCD_BUSY_PIN);
+    CLR_BIT(LCD_CTRL_PORT, LCD_EN);
+#if defined four_bits_mode
+    _delay_us(1);
+    send_falling_edge(); // second nibble (address counter) is ignored
+#else
+    _delay_us(1);
+#endif
+  } while (busy && --tries);
+  CLR_BIT(LCD_CTRL_PORT, LCD_RW);
+  DIO_REG_WRITE_MASK(LCD_DATA_DDR, LCD_DATA_MASK, 0xFF);
+}
+
+/**
+ * @brief  Send one step of the reset-by-instruction sequence. The controller
+ *         still runs an 8-bit interface here, so only D7-D4 are meaningful.
+ * @param  value Function set value (0x30 or 0x20).
+ * @return None
+ */
+static void send_reset_step(unsigned char value) {
 #if defined eight_bits_mode
-  DIO_write_port('A', data);
-  DIO_write('B', RS, 1);
+  send_byte(value, 0);
+#elif defined four_bits_mode
+  CLR_BIT(LCD_CTRL_PORT, LCD_RS);
+  write_data_nibble(value >> 4);
   send_falling_edge();
+#endif
+}
+
+/**
+ * @brief  Initialize the LCD driver. Only the power-on reset sequence uses
+ *         fixed delays; every later instruction waits on the busy flag, so
+ *         the init finishes as soon as the controller does.
+ * @param  None
+ * @return None
+ */
+void LCD_vInit(void) {
+  DIO_REG_WRITE_MASK(LCD_DATA_DDR, LCD_DATA_MASK, 0xFF);
+  DIO_REG_WRITE_MASK(LCD_CTRL_DDR,
+                     (1 << LCD_EN) | (1 << LCD_RW) | (1 << LCD_RS), 0xFF);
+  CLR_BIT(LCD_CTRL_PORT, LCD_RW);
+  _delay_ms(LCD_POWER_ON_MS);
 
+  /* reset by instruction, the busy flag is not valid before it completes */
+  send_reset_step(0x30);
+  _delay_us(4100);
+  send_reset_step(0x30);
+  _delay_us(100);
+  send_reset_step(0x30);
+  _delay_us(LCD_EXEC_US);
+#if defined eight_bits_mode
+  LCD_vSend_cmd(EIGHT_BITS); // 8 bit mode
 #elif defined four_bits_mode
-  write_high_nibble('A', data >> 4);
-  DIO_write('A', RS, 1);
-  send_falling_edge();
-  write_high_nibble('A', data);
-  DIO_write('A', RS, 1);
-  send_falling_edge();
+  send_reset_step(0x20); // switch the interface to 4 bits
+  _delay_us(LCD_EXEC_US);
+  LCD_vSend_cmd(FOUR_BITS); // 4bit mode, 2 lines
 #endif
-  _delay_ms(1);
+  LCD_vSend_cmd(CURSOR_ON_DISPLAN_ON); // display on cursor on
+  LCD_vSend_cmd(CLR_SCREEN);           // clear the screen
+  LCD_vSend_cmd(ENTRY_MODE);           // entry mode
+}
+
+/**
+ * @brief  Send a command to the LCD.
+ * @param  cmd The command to send.
+ * @return None
+ */
+void LCD_vSend_cmd(char cmd) {
+  LATENCY_STAMP(LATENCY_BUFFER, LATENCY_SRC_LCD);
+  wait_ready();
+  send_byte(cmd, 0);
+  LATENCY_STAMP(LATENCY_PINS, LATENCY_SRC_LCD);
+}
+
+/**
+ * @brief  Send a character to the LCD.
+ * @param  data The character to send.
+ * @return None
+ */
+void LCD_vSend_char(char data) {
+  PROFILE_BEGIN(PROF_LCD_CHAR);
+  LATENCY_STAMP(LATENCY_BUFFER, LATENCY_SRC_LCD);
+  wait_ready();
+  send_byte(data, 1);
+  LATENCY_STAMP(LATENCY_PINS, LATENCY_SRC_LCD);
+  PROFILE_END(PROF_LCD_CHAR);
 }
 
 /**
@@ -129,7 +212,7 @@ void LCD_vSend_char(char data) {
  * @param  data Pointer to the string.
  * @return None
  */
-void LCD_vSend_string(char *data) {
+void LCD_vSend_string(const char *data) {
   while ((*data) != '\0') {
     LCD_vSend_char(*data);
     data++;
@@ -141,10 +224,7 @@ void LCD_vSend_string(char *data) {
  * @param  None
  * @return None
  */
-void LCD_clearscreen() {
-  LCD_vSend_cmd(CLR_SCREEN);
-  _delay_ms(10);
-}
+void LCD_clearscreen() { LCD_vSend_cmd(CLR_SCREEN); }
 
 /**
  * @brief  Move the cursor to a specific position.
@@ -162,5 +242,4 @@ void LCD_movecursor(char row, char coloumn) {
     data = 0xc0 + coloumn - 1;
   }
   LCD_vSend_cmd(data);
-  _delay_ms(1);
 }
@@ -12,7 +12,10 @@
 /*******************************************************************************
  *                                  Includes                                   *
  *******************************************************************************/
-#include "../../MCAL/DIO/DIO.h"
+#include "../../LIB/board_pinmap.h"
+#include "../../LIB/latency.h"
+#include "../../LIB/profiler.h"
+#include "../../LIB/std_macros.h"
 #include "LCD_config.h"
 
 /*******************************************************************************
@@ -22,16 +25,17 @@
 #define CURSOR_ON_DISPLAN_ON 0x0e
 #define RETURN_HOME 0x02
 #define ENTRY_MODE 0x06
+#define SET_CGRAM_ADDR 0x40 // | (glyph code << 3) + glyph row
+
+/* HD44780 timing: power-on wait, instruction execution time (us) and a bound
+ * on busy-flag polling (~5us per poll, ~10ms in total) */
+#define LCD_POWER_ON_MS 40
+#define LCD_EXEC_US 40
+#define LCD_BUSY_TRIES 2000
 
 #if defined four_bits_mode
-#define EN 0
-#define RW 1
-#define RS 2
 #define FOUR_BITS 0x28
 #elif defined eight_bits_mode
-#define EN 0
-#define RS 1
-#define RW 2
 #define EIGHT_BITS 0x38
 #endif
 
@@ -65,7 +69,7 @@ void LCD_vSend_char(char data);
  * @param  data Pointer to the string.
  * @return None
  */
-void LCD_vSend_string(char *data);
+void LCD_vSend_string(const char *data);
 
 /**
  * @brief  Clear the LCD screen.
@@ -0,0 +1,106 @@
+/******************************************************************************
+ * Module: HAL
+ * File Name: LCD_big.c
+ * Description: Source file for the two-row big digits of the LCD
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "LCD_big.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* CGRAM codes of the glyphs, in the order of lcd_big_glyphs */
+#define LCD_BIG_FIRST_GLYPH 1
+#define LT 1  // left top corner
+#define UB 2  // upper bar
+#define RT 3  // right top corner
+#define LL 4  // left lower corner
+#define LB 5  // lower bar
+#define LR 6  // right lower corner
+#define UMB 7 // upper and lower bars
+#define LCD_BIG_GLYPHS 7
+
+/* Character ROM cells */
+#define BL ' '  // blank
+#define FB 0xFF // full block
+#define LCD_BIG_DOT 0xA5 // centred dot
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+/* 5x8 rows of each glyph, read from flash */
+static const unsigned char lcd_big_glyphs[LCD_BIG_GLYPHS][8] PROGMEM = {
+    {0x07, 0x0F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F}, // LT
+    {0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00}, // UB
+    {0x1C, 0x1E, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F}, // RT
+    {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x0F, 0x07}, // LL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F}, // LB
+    {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1E, 0x1C}, // LR
+    {0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x1F, 0x1F}, // UMB
+};
+
+/* Top row then bottom row cells of 0-9, read from flash */
+static const unsigned char lcd_big_cells[10][2 * LCD_BIG_WIDTH] PROGMEM = {
+    {LT, UB, RT, LL, LB, LR},   {UB, RT, BL, LB, FB, LB},
+    {UMB, UMB, RT, LL, LB, LB}, {UMB, UMB, RT, LB, LB, LR},
+    {LL, LB, FB, BL, BL, FB},   {LL, UMB, UMB, LB, LB, LR},
+    {LT, UMB, UMB, LL, LB, LR}, {UB, UB, RT, BL, BL, FB},
+    {LT, UMB, RT, LL, LB, LR},  {LT, UMB, RT, LB, LB, LR},
+};
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Load the big digit glyphs into CGRAM.
+ * @param  None
+ * @return None
+ */
+void LCD_vbig_init(void) {
+  unsigned char i;
+
+  // the address counter steps through CGRAM like through a row
+  LCD_vSend_cmd(SET_CGRAM_ADDR | (LCD_BIG_FIRST_GLYPH << 3));
+  for (i = 0; i < sizeof(lcd_big_glyphs); i++) {
+    LCD_vSend_char(pgm_read_byte(&lcd_big_glyphs[0][0] + i));
+  }
+  LCD_movecursor(1, 1); // back to DDRAM
+}
+
+/**
+ * @brief  Draw a big digit on both rows.
+ * @param  coloumn Column of its left edge (1-14).
+ * @param  number The number (0-9).
+ * @return None
+ */
+void LCD_vbig_digit(char coloumn, unsigned char number) {
+  const unsigned char *cells = lcd_big_cells[number];
+  unsigned char i;
+
+  LCD_movecursor(1, coloumn);
+  for (i = 0; i < 2 * LCD_BIG_WIDTH; i++) {
+    if (i == LCD_BIG_WIDTH) {
+      LCD_movecursor(2, coloumn);
+    }
+    LCD_vSend_char(pgm_read_byte(&cells[i]));
+  }
+}
+
+/**
+ * @brief  Draw a two-row colon.
+ * @param  coloumn The column (1-16).
+ * @return None
+ */
+void LCD_vbig_colon(char coloumn) {
+  LCD_movecursor(1, coloumn);
+  LCD_vSend_char(LCD_BIG_DOT);
+  LCD_movecursor(2, coloumn);
+  LCD_vSend_char(LCD_BIG_DOT);
+}
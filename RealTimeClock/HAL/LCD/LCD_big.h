@@ -0,0 +1,54 @@
+/******************************************************************************
+ * Module: HAL
+ * File Name: LCD_big.h
+ * Description: Header file for the two-row big digits of the LCD
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef LCD_BIG_H_
+#define LCD_BIG_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "LCD.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * A big digit is 3 columns wide and takes both rows. It is built from seven
+ * bar and corner glyphs held in CGRAM codes 1-7 (code 0 would end a string),
+ * plus the blank and the full block of the character ROM.
+ */
+#define LCD_BIG_WIDTH 3
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Load the big digit glyphs into CGRAM. Call once after LCD_vInit();
+ *         CGRAM keeps them through every screen clear.
+ * @param  None
+ * @return None
+ */
+void LCD_vbig_init(void);
+
+/**
+ * @brief  Draw a big digit on both rows.
+ * @param  coloumn Column of its left edge (1-14).
+ * @param  number The number (0-9).
+ * @return None
+ */
+void LCD_vbig_digit(char coloumn, unsigned char number);
+
+/**
+ * @brief  Draw a two-row colon (a centred dot on each row).
+ * @param  coloumn The column (1-16).
+ * @return None
+ */
+void LCD_vbig_colon(char coloumn);
+
+#endif /* LCD_BIG_H_ */
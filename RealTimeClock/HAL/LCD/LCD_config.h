@@ -9,9 +9,21 @@
 #ifndef LCD_CONFIG_H_
 #define LCD_CONFIG_H_
 
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "../../LIB/board_pinmap.h"
+
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
+/* The bus width is a property of the board, see LCD_BUS_WIDTH in the pin map */
+#if LCD_BUS_WIDTH == 8
+#define eight_bits_mode
+#elif LCD_BUS_WIDTH == 4
 #define four_bits_mode
+#else
+#error "LCD_config.h: LCD_BUS_WIDTH must be 4 or 8"
+#endif
 
 #endif /* LCD_CONFIG_H_ */
\ No newline at end of file
@@ -11,28 +11,291 @@
  *******************************************************************************/
 #include "seven segment.h"
 #include "../../MCAL/DIO/DIO.h"
+#include "../../MCAL/SPI/SPI.h"
+#include "../../MCAL/Timer/timer.h"
+#include <avr/pgmspace.h>
+
+#if BOARD_HAS_SEVSEG
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+/* Enable bit of each digit, set up at init so the refresh needs no shift */
+static unsigned char sevseg_enables[SEVSEG_DIGITS];
+
+/* Segments of 0-9, read from flash */
+static const unsigned char sevseg_digits[10] PROGMEM = {
+    0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x47, 0x7f, 0x6f};
+
+/* Front and back frames, one segment byte per digit */
+static unsigned char sevseg_frames[2][SEVSEG_DIGITS];
+static volatile unsigned char sevseg_front = 0;
+static volatile unsigned char sevseg_swap = 0; // back frame published
+
+/* Brightness level and lit timer counts of each digit */
+static unsigned char sevseg_levels[SEVSEG_DIGITS];
+static volatile unsigned char sevseg_on_counts[SEVSEG_DIGITS];
+
+#if SEVSEG_SPI
+/* Bytes on their way to the shift registers (digit register first, it is
+ * the far one), and the segments and digit enables last latched */
+static unsigned char sevseg_spi_out[2];
+static unsigned char sevseg_segments;
+static unsigned char sevseg_enabled;
+#endif
 
 /*******************************************************************************
  *                             Functions Definitions                           *
  *******************************************************************************/
 
+#if SEVSEG_SPI
+/**
+ * @brief  Shift segments and digit enables out and latch them together.
+ *         Returns at once; the SPI interrupt sends the second byte.
+ * @param  segments Segments to light.
+ * @param  enabled Enable bits of the digits to light (0 for none).
+ * @return None
+ */
+static void seven_seg_vlatch(unsigned char segments, unsigned char enabled) {
+  if (SPI_u8is_busy()) {
+    return; // not with phases of SEVSEG_MIN_PHASE_COUNTS (two bytes: 4us)
+  }
+  sevseg_segments = segments;
+  sevseg_enabled = enabled;
+  sevseg_spi_out[0] = ~enabled; // active low
+  sevseg_spi_out[1] = segments;
+  SPI_u8start(sevseg_spi_out, sizeof(sevseg_spi_out));
+}
+#endif
+
 /**
- * @brief  Initialize the seven segment driver.
- * @param  port_name The port name ('A', 'B', 'C', 'D').
+ * @brief  Initialize the segment and digit select pins from the board pin map.
+ * @param  None
  * @return None
  */
-void seven_seg_vinit(unsigned char port_name) {
-  DIO_set_port_direction(port_name, 0xFF);
+void seven_seg_vinit(void) {
+  unsigned char digit;
+
+  for (digit = 0; digit < SEVSEG_DIGITS; digit++) {
+    sevseg_enables[digit] = SEVSEG_DIGIT_ENABLE(digit);
+  }
+#if SEVSEG_SPI
+  SPI_vInit();
+  seven_seg_vlatch(0, 0); // all off
+  SPI_vflush();
+#else
+  SEVSEG_DATA_DDR = 0xFF;
+  DIO_REG_WRITE_MASK(SEVSEG_DIGIT_PORT, SEVSEG_DIGIT_MASK, 0xFF); // all off
+  DIO_REG_WRITE_MASK(SEVSEG_DIGIT_DDR, SEVSEG_DIGIT_MASK, 0xFF);
+#endif
+  seven_seg_vset_all_brightness(SEVSEG_LEVELS - 1);
 }
 
 /**
- * @brief  Write a number to the seven segment display.
- * @param  portname The port name ('A', 'B', 'C', 'D').
+ * @brief  Write a number to the seven segment data port.
  * @param  number The number to display (0-9).
  * @return None
  */
-void seven_seg_write(unsigned char portname, unsigned char number) {
-  unsigned char arr[] = {0x3f, 0x06, 0x5b, 0x4f, 0x66,
-                         0x6d, 0x7d, 0x47, 0x7f, 0x6f};
-  DIO_write_port(portname, arr[number]);
-}
\ No newline at end of file
+void seven_seg_write(unsigned char number) {
+#if SEVSEG_SPI
+  seven_seg_vlatch(seven_seg_u8encode(number), sevseg_enabled);
+#else
+  SEVSEG_DATA_PORT = seven_seg_u8encode(number);
+#endif
+}
+
+/**
+ * @brief  Enable one digit of the multiplexed display (active low).
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @return None
+ */
+void seven_seg_select_digit(unsigned char digit) {
+#if SEVSEG_SPI
+  seven_seg_vlatch(sevseg_segments, sevseg_enables[digit]);
+#else
+  // called from the refresh ISR, where the read-modify-write is safe
+  SEVSEG_DIGIT_PORT =
+      (SEVSEG_DIGIT_PORT | SEVSEG_DIGIT_MASK) & ~sevseg_enables[digit];
+#endif
+}
+
+/**
+ * @brief  Segment pattern of a number.
+ * @param  number The number (0-9).
+ * @return The segments to light, without the decimal point.
+ */
+unsigned char seven_seg_u8encode(unsigned char number) {
+  return pgm_read_byte(&sevseg_digits[number]);
+}
+
+/**
+ * @brief  Whether the back frame can be drawn.
+ * @param  None
+ * @return 1 if no published frame is waiting for its swap, 0 otherwise.
+ */
+unsigned char seven_seg_u8back_free(void) { return !sevseg_swap; }
+
+/**
+ * @brief  Draw a number into the back frame (clears the decimal point).
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @param  number The number (0-9).
+ * @return None
+ */
+void seven_seg_vset_digit(unsigned char digit, unsigned char number) {
+  sevseg_frames[!sevseg_front][digit] = seven_seg_u8encode(number);
+}
+
+/**
+ * @brief  Draw a raw segment pattern into the back frame.
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @param  segments Segments to light, SEVSEG_DP for the decimal point.
+ * @return None
+ */
+void seven_seg_vset_segments(unsigned char digit, unsigned char segments) {
+  sevseg_frames[!sevseg_front][digit] = segments;
+}
+
+/**
+ * @brief  Turn the decimal point of a digit in the back frame on or off.
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @param  on 1 to light the point, 0 to clear it.
+ * @return None
+ */
+void seven_seg_vset_dp(unsigned char digit, unsigned char on) {
+  if (on) {
+    sevseg_frames[!sevseg_front][digit] |= SEVSEG_DP;
+  } else {
+    sevseg_frames[!sevseg_front][digit] &= ~SEVSEG_DP;
+  }
+}
+
+/**
+ * @brief  Turn the colon (the points of SEVSEG_COLON_DIGITS) on or off.
+ * @param  on 1 to light the colon, 0 to clear it.
+ * @return None
+ */
+void seven_seg_vset_colon(unsigned char on) {
+  unsigned char digit;
+  for (digit = 0; digit < SEVSEG_DIGITS; digit++) {
+    if ((SEVSEG_COLON_DIGITS >> digit) & 1) {
+      seven_seg_vset_dp(digit, on);
+    }
+  }
+}
+
+/**
+ * @brief  Hand the back frame to the refresh; it is shown from the next
+ *         refresh cycle on.
+ * @param  None
+ * @return None
+ */
+void seven_seg_vpublish(void) {
+  LATENCY_STAMP(LATENCY_BUFFER, LATENCY_SRC_FRAME);
+  // compiler barrier: every frame store lands before the swap request
+  __asm__ __volatile__("" ::: "memory");
+  sevseg_swap = 1;
+}
+
+/**
+ * @brief  Set the brightness of one digit.
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @param  level 0 (off) to SEVSEG_LEVELS - 1 (full).
+ * @return None
+ */
+void seven_seg_vset_brightness(unsigned char digit, unsigned char level) {
+  unsigned int on;
+
+  if (level > SEVSEG_LEVELS - 1) {
+    level = SEVSEG_LEVELS - 1;
+  }
+  LATENCY_STAMP(LATENCY_BUFFER, LATENCY_SRC_LEVEL);
+  sevseg_levels[digit] = level;
+  on = (unsigned int)(SEVSEG_STEP_COUNTS - SEVSEG_BLANK_COUNTS) * level /
+       (SEVSEG_LEVELS - 1);
+  if (on != 0 && on < SEVSEG_MIN_PHASE_COUNTS) {
+    on = SEVSEG_MIN_PHASE_COUNTS;
+  }
+  sevseg_on_counts[digit] = (unsigned char)on; // one byte, no tearing
+}
+
+/**
+ * @brief  Set the brightness of every digit.
+ * @param  level 0 (off) to SEVSEG_LEVELS - 1 (full).
+ * @return None
+ */
+void seven_seg_vset_all_brightness(unsigned char level) {
+  unsigned char digit;
+  for (digit = 0; digit < SEVSEG_DIGITS; digit++) {
+    seven_seg_vset_brightness(digit, level);
+  }
+}
+
+/**
+ * @brief  Brightness of one digit.
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @return The level, 0 to SEVSEG_LEVELS - 1.
+ */
+unsigned char seven_seg_u8get_brightness(unsigned char digit) {
+  return sevseg_levels[digit];
+}
+
+/**
+ * @brief  Drive the display from the Timer0 compare ISR. Each call ends
+ *         one phase (lit or blank) of a digit step and loads the length of
+ *         the next phase into OCR0.
+ * @param  None
+ * @return 1 when a new step started (once per SEVSEG_STEP_COUNTS), 0 else.
+ */
+unsigned char seven_seg_u8refresh_step(void) {
+  static unsigned char digit = 0;
+  static unsigned char lit = 0;
+  unsigned char on;
+  PROFILE_BEGIN(PROF_SEVSEG_WRITE);
+
+  if (lit) {
+    // end of the lit phase: blank for the rest of the step
+#if SEVSEG_SPI
+    seven_seg_vlatch(0, 0);
+#else
+    SEVSEG_DIGIT_PORT |= SEVSEG_DIGIT_MASK;
+    SEVSEG_DATA_PORT = 0;
+#endif
+    timer0_set_compare(SEVSEG_STEP_COUNTS - sevseg_on_counts[digit] - 1);
+    lit = 0;
+    digit++;
+    if (digit >= SEVSEG_DIGITS) {
+      digit = 0;
+    }
+    PROFILE_END(PROF_SEVSEG_WRITE);
+    return 0;
+  }
+
+  // start of a step: the display is dark, load the segments, then enable
+  if (digit == 0 && sevseg_swap) {
+    sevseg_front ^= 1;
+    sevseg_swap = 0;
+    LATENCY_STAMP(LATENCY_PINS, LATENCY_SRC_FRAME);
+  }
+  on = sevseg_on_counts[digit];
+  LATENCY_STAMP(LATENCY_PINS, LATENCY_SRC_LEVEL); // new levels apply here
+  if (on != 0) {
+#if SEVSEG_SPI
+    // one latch: segments and enable change together
+    seven_seg_vlatch(sevseg_frames[sevseg_front][digit],
+                     sevseg_enables[digit]);
+#else
+    SEVSEG_DATA_PORT = sevseg_frames[sevseg_front][digit];
+    seven_seg_select_digit(digit);
+#endif
+    timer0_set_compare(on - 1);
+    lit = 1;
+  } else {
+    timer0_set_compare(SEVSEG_STEP_COUNTS - 1); // digit off, stay dark
+    digit++;
+    if (digit >= SEVSEG_DIGITS) {
+      digit = 0;
+    }
+  }
+  PROFILE_END(PROF_SEVSEG_WRITE);
+  return 1;
+}
+#endif /* BOARD_HAS_SEVSEG */
@@ -9,23 +9,130 @@
 #ifndef SEVEN_SEGMENT_H_
 #define SEVEN_SEGMENT_H_
 
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "../../LIB/board_pinmap.h"
+#include "../../LIB/latency.h"
+#include "../../LIB/profiler.h"
+#include "seven segment_config.h"
+
 /*******************************************************************************
  *                       Software Interfaces Declarations                      *
  *******************************************************************************/
 
 /**
- * @brief  Initialize the seven segment driver.
- * @param  port_name The port name ('A', 'B', 'C', 'D').
+ * @brief  Initialize the segment and digit select pins from the board pin map.
+ * @param  None
  * @return None
  */
-void seven_seg_vinit(unsigned char port_name);
+void seven_seg_vinit(void);
 
 /**
- * @brief  Write a number to the seven segment display.
- * @param  portname The port name ('A', 'B', 'C', 'D').
+ * @brief  Write a number to the seven segment data port.
  * @param  number The number to display (0-9).
  * @return None
  */
-void seven_seg_write(unsigned char portname, unsigned char number);
+void seven_seg_write(unsigned char number);
+
+/**
+ * @brief  Enable one digit of the multiplexed display (active low).
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @return None
+ */
+void seven_seg_select_digit(unsigned char digit);
+
+/**
+ * @brief  Segment pattern of a number.
+ * @param  number The number (0-9).
+ * @return The segments to light, without the decimal point.
+ */
+unsigned char seven_seg_u8encode(unsigned char number);
+
+/*
+ * Display engine: the refresh ISR shows the front frame one digit per call,
+ * the application draws the next frame into the back frame and publishes
+ * it. The frames swap at the start of the next refresh cycle, so a frame is
+ * never shown half drawn. After seven_seg_vpublish() the back frame belongs
+ * to the engine until seven_seg_u8back_free() returns 1; draw every digit
+ * of each new frame.
+ */
+
+/**
+ * @brief  Whether the back frame can be drawn.
+ * @param  None
+ * @return 1 if no published frame is waiting for its swap, 0 otherwise.
+ */
+unsigned char seven_seg_u8back_free(void);
+
+/**
+ * @brief  Draw a number into the back frame (clears the decimal point).
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @param  number The number (0-9).
+ * @return None
+ */
+void seven_seg_vset_digit(unsigned char digit, unsigned char number);
+
+/**
+ * @brief  Draw a raw segment pattern into the back frame.
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @param  segments Segments to light, SEVSEG_DP for the decimal point.
+ * @return None
+ */
+void seven_seg_vset_segments(unsigned char digit, unsigned char segments);
+
+/**
+ * @brief  Turn the decimal point of a digit in the back frame on or off.
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @param  on 1 to light the point, 0 to clear it.
+ * @return None
+ */
+void seven_seg_vset_dp(unsigned char digit, unsigned char on);
+
+/**
+ * @brief  Turn the colon (the points of SEVSEG_COLON_DIGITS) on or off.
+ * @param  on 1 to light the colon, 0 to clear it.
+ * @return None
+ */
+void seven_seg_vset_colon(unsigned char on);
+
+/**
+ * @brief  Hand the back frame to the refresh; it is shown from the next
+ *         refresh cycle on.
+ * @param  None
+ * @return None
+ */
+void seven_seg_vpublish(void);
+
+/**
+ * @brief  Set the brightness of one digit.
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @param  level 0 (off) to SEVSEG_LEVELS - 1 (full).
+ * @return None
+ */
+void seven_seg_vset_brightness(unsigned char digit, unsigned char level);
+
+/**
+ * @brief  Set the brightness of every digit.
+ * @param  level 0 (off) to SEVSEG_LEVELS - 1 (full).
+ * @return None
+ */
+void seven_seg_vset_all_brightness(unsigned char level);
+
+/**
+ * @brief  Brightness of one digit.
+ * @param  digit The digit index (0 is the rightmost digit).
+ * @return The level, 0 to SEVSEG_LEVELS - 1.
+ */
+unsigned char seven_seg_u8get_brightness(unsigned char digit);
+
+/**
+ * @brief  Drive the display from the Timer0 compare ISR. Each call ends
+ *         one phase (lit or blank) of a digit step and loads the length of
+ *         the next phase into OCR0.
+ * @param  None
+ * @return 1 when a new step started (once per SEVSEG_STEP_COUNTS), 0 else.
+ */
+unsigned char seven_seg_u8refresh_step(void);
 
 #endif /* SEVEN_SEGMENT_H_ */
\ No newline at end of file
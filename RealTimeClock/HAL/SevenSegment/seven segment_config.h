@@ -0,0 +1,73 @@
+/******************************************************************************
+ * Module: HAL
+ * File Name: seven segment_config.h
+ * Description: Configuration file for the Seven Segment display engine
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef SEVEN_SEGMENT_CONFIG_H_
+#define SEVEN_SEGMENT_CONFIG_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "../../LIB/board_pinmap.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#if BOARD_HAS_SEVSEG
+/*
+ * Digit d is enabled by bit SEVSEG_DIGIT_FIRST + d of SEVSEG_DIGIT_PORT, or
+ * of the digit shift register on a SEVSEG_SPI board (active low); digit 0
+ * is the rightmost one. The enables follow SEVSEG_DIGITS of the pin map,
+ * so a longer display needs no change to the refresh code.
+ */
+#define SEVSEG_DIGIT_ENABLE(digit) (1 << (SEVSEG_DIGIT_FIRST + (digit)))
+
+#if SEVSEG_DIGIT_FIRST + SEVSEG_DIGITS > 8
+#error "seven segment_config.h: the digit enables do not fit in one port"
+#endif
+#if SEVSEG_DIGITS < 6
+#error "seven segment_config.h: HH.MM.SS needs at least six digits"
+#endif
+
+/* Decimal point segment, and the digits whose point forms the colon
+ * (after the minutes and the hours of HH.MM.SS) */
+#define SEVSEG_DP 0x80
+#define SEVSEG_COLON_DIGITS ((1 << 2) | (1 << 4))
+
+/*
+ * Whole display refresh period. Each digit gets SEVSEG_FRAME_US /
+ * SEVSEG_DIGITS, so the refresh rate does not change with the digit count.
+ * 12000us = ~83Hz. The step is timed by Timer0 at clk/64 (8us per count).
+ */
+#define SEVSEG_FRAME_US 12000UL
+#define SEVSEG_STEP_US (SEVSEG_FRAME_US / SEVSEG_DIGITS)
+#define SEVSEG_STEP_OCR (SEVSEG_STEP_US / 8 - 1)
+
+#if SEVSEG_STEP_OCR > 255
+#error "seven segment_config.h: step too long for Timer0, lower SEVSEG_FRAME_US"
+#endif
+
+/*
+ * Each step lights its digit for a part of the step and blanks the display
+ * for the rest, with at least SEVSEG_BLANK_US dark before the next digit so
+ * the segments never change while a digit is on (no ghosting). The lit part
+ * scales with the digit's brightness level, 0 (off) to SEVSEG_LEVELS - 1.
+ * A phase is at least SEVSEG_MIN_PHASE_COUNTS timer counts long, so the ISR
+ * always reloads OCR0 before the counter gets there.
+ */
+#define SEVSEG_BLANK_US 64
+#define SEVSEG_LEVELS 16
+#define SEVSEG_MIN_PHASE_COUNTS 4
+#define SEVSEG_STEP_COUNTS (SEVSEG_STEP_OCR + 1)
+#define SEVSEG_BLANK_COUNTS (SEVSEG_BLANK_US / 8)
+
+#if SEVSEG_BLANK_COUNTS < SEVSEG_MIN_PHASE_COUNTS
+#error "seven segment_config.h: SEVSEG_BLANK_US below the minimum phase"
+#endif
+#endif /* BOARD_HAS_SEVSEG */
+
+#endif /* SEVEN_SEGMENT_CONFIG_H_ */
@@ -0,0 +1,199 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: board_pinmap.h
+ * Description: Board pin-map profiles shared by all HAL drivers
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef BOARD_PINMAP_H_
+#define BOARD_PINMAP_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                              Profile Selection                              *
+ *******************************************************************************/
+/*
+ * Each profile describes one board layout. Select a profile at build time with
+ * -DBOARD_PROFILE=<id>; the Proteus reference board is used by default.
+ * Ports are given as bare letters so that the drivers resolve them to the
+ * PORTx/DDRx/PINx registers at compile time (single sbi/cbi/in/out accesses).
+ */
+#define BOARD_PROTEUS_RTC 1
+#define BOARD_LCD_ONLY 2
+#define BOARD_SPI_DISPLAY 3
+
+#ifndef BOARD_PROFILE
+#define BOARD_PROFILE BOARD_PROTEUS_RTC
+#endif
+
+/*******************************************************************************
+ *                                  Profiles                                   *
+ *******************************************************************************/
+#if BOARD_PROFILE == BOARD_PROTEUS_RTC
+/* Keypad: rows R0-R3 on PD0-PD3 (outputs), columns C0-C3 on PD4-PD7 (inputs) */
+#define KEYPAD_ROW_PORT_ID D
+#define KEYPAD_ROW_FIRST 0
+#define KEYPAD_COL_PORT_ID D
+#define KEYPAD_COL_FIRST 4
+
+/* LCD: 4-bit bus D4-D7 on PA4-PA7, EN/RW/RS on PA0/PA1/PA2 */
+#define LCD_BUS_WIDTH 4
+#define LCD_DATA_PORT_ID A
+#define LCD_DATA_FIRST 4
+#define LCD_CTRL_PORT_ID A
+#define LCD_CTRL_ON_DATA_PORT 1
+#define LCD_EN 0
+#define LCD_RW 1
+#define LCD_RS 2
+
+/* Seven segment: a-g/dp on PB0-PB7, digit enables EN0-EN5 on PC0-PC5 */
+#define BOARD_HAS_SEVSEG 1
+#define SEVSEG_DATA_PORT_ID B
+#define SEVSEG_DIGIT_PORT_ID C
+#define SEVSEG_DIGIT_FIRST 0
+#define SEVSEG_DIGITS 6
+
+/* PD0/PD1 carry keypad rows, so there is no serial port */
+#define BOARD_HAS_UART 0
+
+/* Ambient light sensor (output rises with light) on PA3/ADC3 */
+#define BOARD_HAS_LIGHT_SENSOR 1
+#define LIGHT_SENSOR_ADC_CHANNEL 3
+
+/* ICP1 (PD6) carries keypad column C2, so there is no 1PPS input */
+#define BOARD_HAS_PPS_INPUT 0
+
+/* SCL/SDA (PC0/PC1) carry digit enables, so there is no RTC chip */
+#define BOARD_HAS_EXT_RTC 0
+
+#elif BOARD_PROFILE == BOARD_LCD_ONLY
+/* Keypad: rows R0-R3 on PB0-PB3 (outputs), columns C0-C3 on PB4-PB7 (inputs) */
+#define KEYPAD_ROW_PORT_ID B
+#define KEYPAD_ROW_FIRST 0
+#define KEYPAD_COL_PORT_ID B
+#define KEYPAD_COL_FIRST 4
+
+/* LCD: 8-bit bus D0-D7 on PA0-PA7, EN/RW/RS on PC2/PC3/PC4 */
+#define LCD_BUS_WIDTH 8
+#define LCD_DATA_PORT_ID A
+#define LCD_DATA_FIRST 0
+#define LCD_CTRL_PORT_ID C
+#define LCD_CTRL_ON_DATA_PORT 0
+#define LCD_EN 2
+#define LCD_RW 3
+#define LCD_RS 4
+
+/* No seven segment board; the time is shown on the LCD */
+#define BOARD_HAS_SEVSEG 0
+
+/* Serial port RXD/TXD on PD0/PD1 */
+#define BOARD_HAS_UART 1
+
+/* Port A (the ADC inputs) is the LCD bus */
+#define BOARD_HAS_LIGHT_SENSOR 0
+
+/* 1PPS calibration reference on ICP1 (PD6) */
+#define BOARD_HAS_PPS_INPUT 1
+#define PPS_PORT_ID D
+#define PPS_PIN 6
+
+/* DS1307/DS3231 RTC chip on the TWI, SCL/SDA on PC0/PC1 (pulled up on the
+ * board) */
+#define BOARD_HAS_EXT_RTC 1
+
+#elif BOARD_PROFILE == BOARD_SPI_DISPLAY
+/* Keypad and LCD as on the Proteus board */
+#define KEYPAD_ROW_PORT_ID D
+#define KEYPAD_ROW_FIRST 0
+#define KEYPAD_COL_PORT_ID D
+#define KEYPAD_COL_FIRST 4
+
+#define LCD_BUS_WIDTH 4
+#define LCD_DATA_PORT_ID A
+#define LCD_DATA_FIRST 4
+#define LCD_CTRL_PORT_ID A
+#define LCD_CTRL_ON_DATA_PORT 1
+#define LCD_EN 0
+#define LCD_RW 1
+#define LCD_RS 2
+
+/*
+ * Seven segment behind two chained 74HC595 on the SPI: MOSI (PB5) feeds the
+ * segment register, whose QH' feeds the digit register; SCK (PB7) drives
+ * both SRCLK and SS (PB4) both RCLK. Segments a-g/dp on QA-QH of the first,
+ * digit enables EN0-EN5 (active low) on QA-QF of the second.
+ */
+#define BOARD_HAS_SEVSEG 1
+#define SEVSEG_SPI 1
+#define SEVSEG_DIGIT_FIRST 0
+#define SEVSEG_DIGITS 6
+
+/* PD0/PD1 carry keypad rows, so there is no serial port */
+#define BOARD_HAS_UART 0
+
+/* Ambient light sensor (output rises with light) on PA3/ADC3 */
+#define BOARD_HAS_LIGHT_SENSOR 1
+#define LIGHT_SENSOR_ADC_CHANNEL 3
+
+/* ICP1 (PD6) carries keypad column C2, so there is no 1PPS input */
+#define BOARD_HAS_PPS_INPUT 0
+
+/* Port C is free of the digit enables: RTC chip on SCL/SDA (PC0/PC1) */
+#define BOARD_HAS_EXT_RTC 1
+
+#else
+#error "board_pinmap.h: unknown BOARD_PROFILE"
+#endif
+
+/* The display is on the ports unless the profile puts it on the SPI */
+#ifndef SEVSEG_SPI
+#define SEVSEG_SPI 0
+#endif
+
+/*******************************************************************************
+ *                              Derived Registers                              *
+ *******************************************************************************/
+#define BOARD_CONCAT_(a, b) a##b
+#define BOARD_CONCAT(a, b) BOARD_CONCAT_(a, b)
+#define BOARD_PORT(id) BOARD_CONCAT(PORT, id)
+#define BOARD_DDR(id) BOARD_CONCAT(DDR, id)
+#define BOARD_PIN(id) BOARD_CONCAT(PIN, id)
+
+#define KEYPAD_ROW_PORT BOARD_PORT(KEYPAD_ROW_PORT_ID)
+#define KEYPAD_ROW_DDR BOARD_DDR(KEYPAD_ROW_PORT_ID)
+#define KEYPAD_ROW_MASK (0x0F << KEYPAD_ROW_FIRST)
+#define KEYPAD_COL_PORT BOARD_PORT(KEYPAD_COL_PORT_ID)
+#define KEYPAD_COL_DDR BOARD_DDR(KEYPAD_COL_PORT_ID)
+#define KEYPAD_COL_PIN BOARD_PIN(KEYPAD_COL_PORT_ID)
+#define KEYPAD_COL_MASK (0x0F << KEYPAD_COL_FIRST)
+
+#define LCD_DATA_PORT BOARD_PORT(LCD_DATA_PORT_ID)
+#define LCD_DATA_DDR BOARD_DDR(LCD_DATA_PORT_ID)
+#define LCD_DATA_PIN BOARD_PIN(LCD_DATA_PORT_ID)
+#define LCD_DATA_MASK (((1 << LCD_BUS_WIDTH) - 1) << LCD_DATA_FIRST)
+#define LCD_BUSY_PIN (LCD_DATA_FIRST + LCD_BUS_WIDTH - 1)
+#define LCD_CTRL_PORT BOARD_PORT(LCD_CTRL_PORT_ID)
+#define LCD_CTRL_DDR BOARD_DDR(LCD_CTRL_PORT_ID)
+
+#if BOARD_HAS_SEVSEG
+#if !SEVSEG_SPI
+#define SEVSEG_DATA_PORT BOARD_PORT(SEVSEG_DATA_PORT_ID)
+#define SEVSEG_DATA_DDR BOARD_DDR(SEVSEG_DATA_PORT_ID)
+#define SEVSEG_DIGIT_PORT BOARD_PORT(SEVSEG_DIGIT_PORT_ID)
+#define SEVSEG_DIGIT_DDR BOARD_DDR(SEVSEG_DIGIT_PORT_ID)
+#endif
+#define SEVSEG_DIGIT_MASK                                                      \
+  (((1 << SEVSEG_DIGITS) - 1) << SEVSEG_DIGIT_FIRST)
+#endif
+
+#if BOARD_HAS_PPS_INPUT
+#define PPS_PORT BOARD_PORT(PPS_PORT_ID)
+#define PPS_DDR BOARD_DDR(PPS_PORT_ID)
+#endif
+
+#endif /* BOARD_PINMAP_H_ */
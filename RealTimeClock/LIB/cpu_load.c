@@ -0,0 +1,143 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: cpu_load.c
+ * Description: CPU load and per-ISR time accounting on the free-running Timer1
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "cpu_load.h"
+#include <util/atomic.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define F_CPU 8000000UL
+#define CPU_LOAD_CYCLES_PER_MS (F_CPU / 1000UL)
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+volatile unsigned long cpu_load_isr_cycles[CPU_LOAD_ISRS];
+
+/* Current window */
+static unsigned int cpu_load_window_start;
+static unsigned int cpu_load_last_ms;
+static unsigned int cpu_load_last_cycles;
+static unsigned long cpu_load_passes = 0;
+static unsigned int cpu_load_min_pass = 0xFFFF;
+static unsigned char cpu_load_started = 0;
+
+/* Results of the last window */
+static unsigned int cpu_load_busy = 0;
+static unsigned int cpu_load_isr_share[CPU_LOAD_ISRS];
+static unsigned int cpu_load_idle_pass = 0;
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Share of the window in tenths of a percent.
+ * @param  cycles Cycles spent.
+ * @param  window_cycles Length of the window in cycles.
+ * @return cycles / window_cycles in tenths of a percent, at most 1000.
+ */
+static unsigned int cpu_load_u16share(unsigned long cycles,
+                                      unsigned long window_cycles) {
+  unsigned long share = cycles / (window_cycles / 1000);
+  return (share > 1000) ? 1000 : (unsigned int)share;
+}
+
+/**
+ * @brief  Compute the results of the window that just ended.
+ * @param  elapsed_ms Length of the window.
+ * @return None
+ */
+static void cpu_load_vclose_window(unsigned int elapsed_ms) {
+  unsigned long window_cycles =
+      (unsigned long)elapsed_ms * CPU_LOAD_CYCLES_PER_MS;
+  unsigned long isr_cycles[CPU_LOAD_ISRS];
+  unsigned long idle;
+  unsigned char i;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (i = 0; i < CPU_LOAD_ISRS; i++) {
+      isr_cycles[i] = cpu_load_isr_cycles[i];
+      cpu_load_isr_cycles[i] = 0;
+    }
+  }
+  for (i = 0; i < CPU_LOAD_ISRS; i++) {
+    cpu_load_isr_share[i] = cpu_load_u16share(isr_cycles[i], window_cycles);
+  }
+
+  if (cpu_load_min_pass != 0xFFFF) {
+    cpu_load_idle_pass = cpu_load_min_pass;
+    idle = cpu_load_passes * cpu_load_min_pass;
+    cpu_load_busy = (idle < window_cycles)
+                        ? 1000 - cpu_load_u16share(idle, window_cycles)
+                        : 0;
+  } else {
+    cpu_load_busy = 1000; // not a single uninterrupted pass
+  }
+  cpu_load_passes = 0;
+  cpu_load_min_pass = 0xFFFF;
+}
+
+/**
+ * @brief  Count one pass of the main loop; closes the window every
+ *         CPU_LOAD_WINDOW_MS.
+ * @param  now_ms Free-running millisecond tick of the caller.
+ * @return None
+ */
+void cpu_load_vpass(unsigned int now_ms) {
+  unsigned int now_cycles, pass;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { now_cycles = TCNT1; }
+
+  if (!cpu_load_started) {
+    cpu_load_started = 1;
+    cpu_load_window_start = now_ms;
+  } else {
+    // a pass that saw no tick is shorter than a tick, so the 16-bit
+    // difference is exact and no tick ISR is inside it
+    pass = now_cycles - cpu_load_last_cycles;
+    if (now_ms == cpu_load_last_ms && pass < cpu_load_min_pass) {
+      cpu_load_min_pass = pass;
+    }
+    cpu_load_passes++;
+  }
+  cpu_load_last_cycles = now_cycles;
+  cpu_load_last_ms = now_ms;
+
+  if ((unsigned int)(now_ms - cpu_load_window_start) >= CPU_LOAD_WINDOW_MS) {
+    cpu_load_vclose_window(now_ms - cpu_load_window_start);
+    cpu_load_window_start = now_ms;
+  }
+}
+
+/**
+ * @brief  CPU utilisation over the last window.
+ * @param  None
+ * @return Busy time in tenths of a percent (0-1000).
+ */
+unsigned int cpu_load_u16busy(void) { return cpu_load_busy; }
+
+/**
+ * @brief  Time share of one ISR over the last window.
+ * @param  isr CPU_LOAD_ISR_* id.
+ * @return ISR time in tenths of a percent (0-1000).
+ */
+unsigned int cpu_load_u16isr_share(unsigned char isr) {
+  return cpu_load_isr_share[isr];
+}
+
+/**
+ * @brief  Idle baseline of the last window.
+ * @param  None
+ * @return Cycles of the shortest uninterrupted main loop pass.
+ */
+unsigned int cpu_load_u16idle_pass(void) { return cpu_load_idle_pass; }
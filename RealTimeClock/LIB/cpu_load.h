@@ -0,0 +1,83 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: cpu_load.h
+ * Description: CPU load and per-ISR time accounting on the free-running Timer1
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef CPU_LOAD_H_
+#define CPU_LOAD_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * The main loop calls cpu_load_vpass() once per pass. The shortest pass of a
+ * window that no tick interrupt hit is the idle baseline: the cost of one
+ * pass with nothing to do. passes x baseline is the idle time, the rest of
+ * the window is busy (task work and ISRs). ISRs wrapped in
+ * CPU_LOAD_ISR_BEGIN/END also add their Timer1 cycles to a per-ISR share.
+ * Timer1 must run free at clk/1 (timer1_free_running_init()).
+ */
+#define CPU_LOAD_WINDOW_MS 1000
+
+/* ISRs with a time share */
+#define CPU_LOAD_ISR_TIMER0 0 // system tick and display refresh
+#define CPU_LOAD_ISR_TIMER2 1 // 1 Hz clock tick
+#define CPU_LOAD_ISR_EEPROM 2 // EEPROM ready
+#define CPU_LOAD_ISR_UART 3   // USART data register empty
+#define CPU_LOAD_ISR_ADC 4    // ADC conversion complete
+#define CPU_LOAD_ISR_TIMER1 5 // input capture and overflow (calibration)
+#define CPU_LOAD_ISR_TWI 6    // TWI bus event (external RTC chip)
+#define CPU_LOAD_ISR_SPI 7    // SPI byte sent (shift-register display)
+#define CPU_LOAD_ISRS 8
+
+/* Cycles spent in each ISR in the current window (the prologue and epilogue
+ * the compiler adds around the body are not counted) */
+extern volatile unsigned long cpu_load_isr_cycles[CPU_LOAD_ISRS];
+
+/* Only for use inside ISRs, where the TCNT1 read cannot be interrupted */
+#define CPU_LOAD_ISR_BEGIN() unsigned int cpu_load_isr_start = TCNT1
+#define CPU_LOAD_ISR_END(isr)                                                  \
+  cpu_load_isr_cycles[(isr)] += (unsigned int)(TCNT1 - cpu_load_isr_start)
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Count one pass of the main loop; closes the window every
+ *         CPU_LOAD_WINDOW_MS.
+ * @param  now_ms Free-running millisecond tick of the caller.
+ * @return None
+ */
+void cpu_load_vpass(unsigned int now_ms);
+
+/**
+ * @brief  CPU utilisation over the last window.
+ * @param  None
+ * @return Busy time in tenths of a percent (0-1000).
+ */
+unsigned int cpu_load_u16busy(void);
+
+/**
+ * @brief  Time share of one ISR over the last window.
+ * @param  isr CPU_LOAD_ISR_* id.
+ * @return ISR time in tenths of a percent (0-1000).
+ */
+unsigned int cpu_load_u16isr_share(unsigned char isr);
+
+/**
+ * @brief  Idle baseline of the last window.
+ * @param  None
+ * @return Cycles of the shortest uninterrupted main loop pass.
+ */
+unsigned int cpu_load_u16idle_pass(void);
+
+#endif /* CPU_LOAD_H_ */
@@ -0,0 +1,203 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: latency.c
+ * Description: Source file for the key-to-display latency tracer
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "latency.h"
+
+#if LATENCY_TRACE_ENABLED
+#include <avr/io.h>
+#include <util/atomic.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define F_CPU 8000000UL
+#define LATENCY_TIMEOUT_CYCLES (LATENCY_TIMEOUT_MS * (F_CPU / 1000))
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+volatile unsigned char latency_next = LATENCY_DETECT;
+
+/* 32-bit cycle clock: Timer1 counts folded in by every system tick */
+static volatile unsigned long latency_clock = 0;
+static volatile unsigned int latency_last = 0;
+
+/* Open trace */
+static unsigned long latency_stamps[LATENCY_STAMPS];
+static unsigned char latency_source; // output of the buffer stamp
+
+static volatile latency_hist_t latency_table[LATENCY_ROWS];
+static volatile unsigned int latency_incomplete = 0;
+
+static const char *const latency_names[LATENCY_ROWS] = {
+    "debounce", "to ui", "ui>disp", "disp>pin", "total"};
+
+static const char *const latency_labels[LATENCY_BUCKETS] = {
+    "64u", "128u", "256u", "512u", "1m",  "2m",
+    "4m",  "8m",   "16m",  "33m",  "66m", ">66m"};
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Read the stamp clock (callers keep interrupts off).
+ * @param  None
+ * @return CPU cycles on a 32-bit count.
+ */
+static unsigned long latency_u32now(void) {
+  return latency_clock + (unsigned int)(TCNT1 - latency_last);
+}
+
+/**
+ * @brief  Extend the stamp clock; called from the system tick ISR.
+ * @param  None
+ * @return None
+ */
+void latency_vtick(void) {
+  unsigned int now = TCNT1;
+  latency_clock += (unsigned int)(now - latency_last);
+  latency_last = now;
+}
+
+/**
+ * @brief  Histogram bucket of a span.
+ * @param  cycles Span in CPU cycles.
+ * @return 0 to LATENCY_BUCKETS - 1.
+ */
+static unsigned char latency_u8bucket(unsigned long cycles) {
+  unsigned char bucket = 0;
+
+  cycles >>= 9; // 64us units
+  while (cycles != 0 && bucket < LATENCY_BUCKETS - 1) {
+    cycles >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+/**
+ * @brief  Count a span in one histogram row (callers keep interrupts off).
+ * @param  row Span row.
+ * @param  cycles Span in CPU cycles.
+ * @return None
+ */
+static void latency_vcount(unsigned char row, unsigned long cycles) {
+  volatile unsigned int *count =
+      &latency_table[row].bucket[latency_u8bucket(cycles)];
+  if (*count != 0xFFFF) {
+    (*count)++;
+  }
+}
+
+/**
+ * @brief  Open a trace for a key the scan just saw go down.
+ * @param  None
+ * @return None
+ */
+void latency_vbegin(void) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    unsigned long now = latency_u32now();
+    if (latency_next == LATENCY_EVENT &&
+        now - latency_stamps[LATENCY_DETECT] < LATENCY_TIMEOUT_CYCLES) {
+      return; // still debouncing: a bounce, or a second key of a combo
+    }
+    if (latency_next != LATENCY_DETECT && latency_incomplete != 0xFFFF) {
+      latency_incomplete++; // the last key changed nothing on the display
+    }
+    latency_stamps[LATENCY_DETECT] = now;
+    latency_next = LATENCY_EVENT;
+  }
+}
+
+/**
+ * @brief  Stamp the next stage of the open trace.
+ * @param  stage LATENCY_* stamp.
+ * @param  source LATENCY_SRC_* output.
+ * @return None
+ */
+void latency_vstamp(unsigned char stage, unsigned char source) {
+  unsigned char i;
+  unsigned long now;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (stage != latency_next || stage == LATENCY_DETECT) {
+      return; // an ISR took this stage first, or no trace is open
+    }
+    now = latency_u32now();
+    if (now - latency_stamps[LATENCY_DETECT] >= LATENCY_TIMEOUT_CYCLES) {
+      // the key changed nothing: this output belongs to something else
+      if (latency_incomplete != 0xFFFF) {
+        latency_incomplete++;
+      }
+      latency_next = LATENCY_DETECT;
+      return;
+    }
+    if (stage == LATENCY_PINS && source != latency_source) {
+      return; // another output
+    }
+    latency_source = source;
+    latency_stamps[stage] = now;
+    if (stage < LATENCY_PINS) {
+      latency_next = stage + 1;
+      return;
+    }
+    for (i = 1; i < LATENCY_STAMPS; i++) {
+      latency_vcount(i - 1, latency_stamps[i] - latency_stamps[i - 1]);
+    }
+    latency_vcount(LATENCY_ROW_TOTAL, latency_stamps[LATENCY_PINS] -
+                                          latency_stamps[LATENCY_DETECT]);
+    latency_next = LATENCY_DETECT;
+  }
+}
+
+/**
+ * @brief  Take a consistent copy of one histogram.
+ * @param  row Span row (0 to LATENCY_ROW_TOTAL).
+ * @param  hist Pointer to store the histogram.
+ * @return None
+ */
+void latency_vget(unsigned char row, latency_hist_t *hist) {
+  unsigned char i;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (i = 0; i < LATENCY_BUCKETS; i++) {
+      hist->bucket[i] = latency_table[row].bucket[i];
+    }
+  }
+}
+
+/**
+ * @brief  Traces dropped because no display output followed the key in time.
+ * @param  None
+ * @return The count, stops at 65535.
+ */
+unsigned int latency_u16incomplete(void) {
+  unsigned int count;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { count = latency_incomplete; }
+  return count;
+}
+
+/**
+ * @brief  Name of a histogram row for the LCD and the serial dump.
+ * @param  row Span row.
+ * @return Pointer to the name (at most 8 characters).
+ */
+const char *latency_name(unsigned char row) { return latency_names[row]; }
+
+/**
+ * @brief  Upper bound of a bucket, for the LCD and the serial dump.
+ * @param  bucket 0 to LATENCY_BUCKETS - 1.
+ * @return Pointer to the label (at most 4 characters).
+ */
+const char *latency_bucket_label(unsigned char bucket) {
+  return latency_labels[bucket];
+}
+#endif /* LATENCY_TRACE_ENABLED */
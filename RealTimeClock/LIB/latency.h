@@ -0,0 +1,142 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: latency.h
+ * Description: Header file for the key-to-display latency tracer
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Build with -DLATENCY_TRACE_ENABLED=1 to trace every key press from the
+ * keypad to the display pins. Each press is stamped when the scan first
+ * sees it, when the debounced event is reported, when the UI starts handling
+ * it, when the first display data is written and when that data reaches the
+ * pins. The time between consecutive stamps and the total go into log2
+ * histograms. Disabled, the macros expand to nothing.
+ *
+ * The stamps are Timer1 cycles (clk/1, free running) extended to 32 bits by
+ * the system tick, which must come at least every 8ms.
+ */
+#ifndef LATENCY_TRACE_ENABLED
+#define LATENCY_TRACE_ENABLED 0
+#endif
+
+/* Stamps of one press, in order */
+#define LATENCY_DETECT 0 // keypad scan sees the key go down
+#define LATENCY_EVENT 1  // debounced press reported
+#define LATENCY_UI 2     // ui_task() starts handling it
+#define LATENCY_BUFFER 3 // first display data written
+#define LATENCY_PINS 4   // that data is on the display pins
+#define LATENCY_STAMPS 5
+
+/* Display outputs, so the pins stamp matches the buffer stamp */
+#define LATENCY_SRC_KEYPAD 0 // detect, event and UI stamps
+#define LATENCY_SRC_LCD 1    // byte sent, on the pins after the enable pulse
+#define LATENCY_SRC_FRAME 2  // 7-segment frame published, shown at the swap
+#define LATENCY_SRC_LEVEL 3  // 7-segment level set, shown at the next step
+
+/* Histogram rows: the span ending at each stamp after LATENCY_DETECT
+ * (row 0 ends at LATENCY_EVENT), then the total */
+#define LATENCY_ROW_TOTAL (LATENCY_STAMPS - 1)
+#define LATENCY_ROWS LATENCY_STAMPS
+
+/* Buckets: bucket 0 is below 64us, each next one doubles the bound, the
+ * last one takes everything from 65.5ms up */
+#define LATENCY_BUCKETS 12
+
+/* A trace not finished by then is counted as incomplete */
+#define LATENCY_TIMEOUT_MS 500
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+/* Histogram of one row; the counts stop at 65535 */
+typedef struct {
+  unsigned int bucket[LATENCY_BUCKETS];
+} latency_hist_t;
+
+#if LATENCY_TRACE_ENABLED
+/* Next stamp the open trace waits for, read by the inline check */
+extern volatile unsigned char latency_next;
+
+#define LATENCY_BEGIN() latency_vbegin()
+#define LATENCY_STAMP(stage, source)                                           \
+  do {                                                                         \
+    if (latency_next == (stage)) {                                             \
+      latency_vstamp((stage), (source));                                       \
+    }                                                                          \
+  } while (0)
+#define LATENCY_TICK() latency_vtick()
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Open a trace for a key the scan just saw go down. A trace still
+ *         debouncing is kept; one that got further or timed out is counted
+ *         as incomplete and replaced.
+ * @param  None
+ * @return None
+ */
+void latency_vbegin(void);
+
+/**
+ * @brief  Stamp the next stage of the open trace (called by LATENCY_STAMP,
+ *         also from ISRs). The pins stamp closes the trace and adds it to
+ *         the histograms.
+ * @param  stage LATENCY_* stamp.
+ * @param  source LATENCY_SRC_* output.
+ * @return None
+ */
+void latency_vstamp(unsigned char stage, unsigned char source);
+
+/**
+ * @brief  Extend the stamp clock; called from the system tick ISR.
+ * @param  None
+ * @return None
+ */
+void latency_vtick(void);
+
+/**
+ * @brief  Take a consistent copy of one histogram.
+ * @param  row Span row (0 to LATENCY_ROW_TOTAL).
+ * @param  hist Pointer to store the histogram.
+ * @return None
+ */
+void latency_vget(unsigned char row, latency_hist_t *hist);
+
+/**
+ * @brief  Traces dropped because no display output followed the key in time.
+ * @param  None
+ * @return The count, stops at 65535.
+ */
+unsigned int latency_u16incomplete(void);
+
+/**
+ * @brief  Name of a histogram row for the LCD and the serial dump.
+ * @param  row Span row.
+ * @return Pointer to the name (at most 8 characters).
+ */
+const char *latency_name(unsigned char row);
+
+/**
+ * @brief  Upper bound of a bucket, for the LCD and the serial dump.
+ * @param  bucket 0 to LATENCY_BUCKETS - 1.
+ * @return Pointer to the label, e.g. "512u" or "16m" (at most 4 characters).
+ */
+const char *latency_bucket_label(unsigned char bucket);
+
+#else
+#define LATENCY_BEGIN()
+#define LATENCY_STAMP(stage, source)
+#define LATENCY_TICK()
+#endif /* LATENCY_TRACE_ENABLED */
+
+#endif /* LATENCY_H_ */
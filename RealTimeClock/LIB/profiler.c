@@ -0,0 +1,99 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: profiler.c
+ * Description: Cycle-counting probes on the free-running Timer1
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static volatile profiler_stats_t profiler_table[PROFILER_PROBES];
+static unsigned int profiler_overhead = 0;
+
+static const char *const profiler_names[PROFILER_PROBES] = {
+    "keypad", "lcd chr", "7seg", "t2 isr", "ui", "run", "storage",
+    "format"};
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Clear the table and measure the cost of an empty probe.
+ * @param  None
+ * @return None
+ */
+void profiler_vInit(void) {
+  unsigned char i;
+  unsigned int start;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (i = 0; i < PROFILER_PROBES; i++) {
+      profiler_table[i].count = 0;
+      profiler_table[i].min = 0xFFFF;
+      profiler_table[i].max = 0;
+      profiler_table[i].total = 0;
+    }
+  }
+  start = profiler_u16now();
+  profiler_overhead = profiler_u16now() - start;
+}
+
+/**
+ * @brief  Add one sample to a probe (called by PROFILE_END).
+ * @param  probe PROF_* id.
+ * @param  cycles Cycles between PROFILE_BEGIN and PROFILE_END.
+ * @return None
+ */
+void profiler_vrecord(unsigned char probe, unsigned int cycles) {
+  volatile profiler_stats_t *entry = &profiler_table[probe];
+
+  cycles = (cycles > profiler_overhead) ? cycles - profiler_overhead : 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (entry->count == 0xFFFF) {
+      // halve the window; the mean is kept and total cannot overflow
+      entry->count >>= 1;
+      entry->total >>= 1;
+    }
+    entry->count++;
+    entry->total += cycles;
+    if (cycles < entry->min) {
+      entry->min = cycles;
+    }
+    if (cycles > entry->max) {
+      entry->max = cycles;
+    }
+  }
+}
+
+/**
+ * @brief  Take a consistent copy of a probe's statistics.
+ * @param  probe PROF_* id.
+ * @param  stats Pointer to store the statistics.
+ * @return None
+ */
+void profiler_vget(unsigned char probe, profiler_stats_t *stats) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    stats->count = profiler_table[probe].count;
+    stats->min = profiler_table[probe].min;
+    stats->max = profiler_table[probe].max;
+    stats->total = profiler_table[probe].total;
+  }
+}
+
+/**
+ * @brief  Name of a probe for the LCD and the serial dump.
+ * @param  probe PROF_* id.
+ * @return Pointer to the name (at most 8 characters).
+ */
+const char *profiler_name(unsigned char probe) {
+  return profiler_names[probe];
+}
+#endif /* PROFILER_ENABLED */
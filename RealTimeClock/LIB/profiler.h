@@ -0,0 +1,109 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: profiler.h
+ * Description: Cycle-counting probes on the free-running Timer1
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Build with -DPROFILER_ENABLED=1 to compile the probes in. Disabled, the
+ * PROFILE_BEGIN/PROFILE_END macros expand to nothing and no table is kept.
+ * Timer1 must run free at clk/1 (timer1_free_running_init()); a probe
+ * measures up to 65535 cycles (8.19ms at 8MHz).
+ */
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 0
+#endif
+
+/* Probe ids, one row of the table each */
+#define PROF_KEYPAD_SCAN 0   // keypad_u8check_press
+#define PROF_LCD_CHAR 1      // LCD_vSend_char
+#define PROF_SEVSEG_WRITE 2  // seven_seg_u8refresh_step
+#define PROF_TIMER2_ISR 3    // 1 Hz clock tick
+#define PROF_TASK_UI 4       // main loop tasks
+#define PROF_TASK_RUN 5
+#define PROF_TASK_STORAGE 6
+#define PROF_FORMAT 7        // rtc_format_vtime
+#define PROFILER_PROBES 8
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+/* Statistics of one probe, in CPU cycles with the probe overhead removed */
+typedef struct {
+  unsigned int count;
+  unsigned int min;
+  unsigned int max;
+  unsigned long total; /* mean = total / count */
+} profiler_stats_t;
+
+#if PROFILER_ENABLED
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include <avr/io.h>
+#include <util/atomic.h>
+
+/**
+ * @brief  Read Timer1; TCNT1 shares the TEMP register with ISRs.
+ * @param  None
+ * @return The Timer1 count.
+ */
+static inline unsigned int profiler_u16now(void) {
+  unsigned int now;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { now = TCNT1; }
+  return now;
+}
+
+#define PROFILE_BEGIN(probe)                                                   \
+  unsigned int profile_start_##probe = profiler_u16now()
+#define PROFILE_END(probe)                                                     \
+  profiler_vrecord((probe), profiler_u16now() - profile_start_##probe)
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Clear the table and measure the cost of an empty probe.
+ * @param  None
+ * @return None
+ */
+void profiler_vInit(void);
+
+/**
+ * @brief  Add one sample to a probe (called by PROFILE_END).
+ * @param  probe PROF_* id.
+ * @param  cycles Cycles between PROFILE_BEGIN and PROFILE_END.
+ * @return None
+ */
+void profiler_vrecord(unsigned char probe, unsigned int cycles);
+
+/**
+ * @brief  Take a consistent copy of a probe's statistics.
+ * @param  probe PROF_* id.
+ * @param  stats Pointer to store the statistics.
+ * @return None
+ */
+void profiler_vget(unsigned char probe, profiler_stats_t *stats);
+
+/**
+ * @brief  Name of a probe for the LCD and the serial dump.
+ * @param  probe PROF_* id.
+ * @return Pointer to the name (at most 8 characters).
+ */
+const char *profiler_name(unsigned char probe);
+
+#else
+#define PROFILE_BEGIN(probe)
+#define PROFILE_END(probe)
+#endif /* PROFILER_ENABLED */
+
+#endif /* PROFILER_H_ */
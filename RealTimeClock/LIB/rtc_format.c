@@ -0,0 +1,155 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: rtc_format.c
+ * Description: Division-free time and date formatting into caller buffers
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "rtc_format.h"
+#include "profiler.h"
+#include <avr/pgmspace.h>
+#if RTC_FORMAT_SNPRINTF
+#include <stdio.h>
+#endif
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+/* Packed BCD of 0-99 */
+static const unsigned char rtc_format_bcd[100] PROGMEM = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99};
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Packed BCD of a two-digit number (tens in the high nibble).
+ * @param  value 0-99.
+ * @return The BCD byte, e.g. 0x42 for 42.
+ */
+unsigned char rtc_format_u8bcd(unsigned char value) {
+  if (value > 99) {
+    value = 99;
+  }
+  return pgm_read_byte(&rtc_format_bcd[value]);
+}
+
+/**
+ * @brief  Write a number as two characters with a leading zero (no null).
+ * @param  value 0-99.
+ * @param  text Buffer of at least 2 characters.
+ * @return None
+ */
+void rtc_format_vtwo_digits(unsigned char value, char *text) {
+  unsigned char bcd = rtc_format_u8bcd(value);
+  text[0] = '0' + (bcd >> 4);
+  text[1] = '0' + (bcd & 0x0F);
+}
+
+#if !RTC_FORMAT_SNPRINTF
+/**
+ * @brief  Write a time as "HH:MM:SS".
+ * @param  hours Hours as shown (0-23, or 1-12).
+ * @param  minutes Minutes (0-59).
+ * @param  seconds Seconds (0-59).
+ * @param  text Buffer of RTC_FORMAT_TIME_SIZE characters.
+ * @return None
+ */
+void rtc_format_vtime(unsigned char hours, unsigned char minutes,
+                      unsigned char seconds, char *text) {
+  PROFILE_BEGIN(PROF_FORMAT);
+  rtc_format_vtwo_digits(hours, &text[0]);
+  text[2] = ':';
+  rtc_format_vtwo_digits(minutes, &text[3]);
+  text[5] = ':';
+  rtc_format_vtwo_digits(seconds, &text[6]);
+  text[8] = '\0';
+  PROFILE_END(PROF_FORMAT);
+}
+
+/**
+ * @brief  Write a 24h time in 12h form as "hh:mm:ss AM" or "hh:mm:ss PM".
+ * @param  hours Hours in 24h form (0-23).
+ * @param  minutes Minutes (0-59).
+ * @param  seconds Seconds (0-59).
+ * @param  text Buffer of RTC_FORMAT_TIME12_SIZE characters.
+ * @return None
+ */
+void rtc_format_vtime12(unsigned char hours, unsigned char minutes,
+                        unsigned char seconds, char *text) {
+  char suffix = (hours >= 12) ? 'P' : 'A';
+
+  if (hours > 12) {
+    hours -= 12;
+  } else if (hours == 0) {
+    hours = 12;
+  }
+  rtc_format_vtime(hours, minutes, seconds, text);
+  text[8] = ' ';
+  text[9] = suffix;
+  text[10] = 'M';
+  text[11] = '\0';
+}
+
+/**
+ * @brief  Write a date as "YYYY-MM-DD".
+ * @param  year 2000-2099.
+ * @param  month 1-12.
+ * @param  day 1-31.
+ * @param  text Buffer of RTC_FORMAT_DATE_SIZE characters.
+ * @return None
+ */
+void rtc_format_vdate(unsigned int year, unsigned char month,
+                      unsigned char day, char *text) {
+  text[0] = '2';
+  text[1] = '0';
+  rtc_format_vtwo_digits((unsigned char)(year - 2000), &text[2]);
+  text[4] = '-';
+  rtc_format_vtwo_digits(month, &text[5]);
+  text[7] = '-';
+  rtc_format_vtwo_digits(day, &text[8]);
+  text[10] = '\0';
+}
+#else
+/* snprintf baseline of the same interface, for the benchmark only */
+
+void rtc_format_vtime(unsigned char hours, unsigned char minutes,
+                      unsigned char seconds, char *text) {
+  PROFILE_BEGIN(PROF_FORMAT);
+  snprintf(text, RTC_FORMAT_TIME_SIZE, "%02u:%02u:%02u", hours, minutes,
+           seconds);
+  PROFILE_END(PROF_FORMAT);
+}
+
+void rtc_format_vtime12(unsigned char hours, unsigned char minutes,
+                        unsigned char seconds, char *text) {
+  char suffix = (hours >= 12) ? 'P' : 'A';
+
+  if (hours > 12) {
+    hours -= 12;
+  } else if (hours == 0) {
+    hours = 12;
+  }
+  snprintf(text, RTC_FORMAT_TIME12_SIZE, "%02u:%02u:%02u %cM", hours, minutes,
+           seconds, suffix);
+}
+
+void rtc_format_vdate(unsigned int year, unsigned char month,
+                      unsigned char day, char *text) {
+  snprintf(text, RTC_FORMAT_DATE_SIZE, "%04u-%02u-%02u", year, month, day);
+}
+#endif
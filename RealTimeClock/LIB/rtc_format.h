@@ -0,0 +1,83 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: rtc_format.h
+ * Description: Division-free time and date formatting into caller buffers
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef RTC_FORMAT_H_
+#define RTC_FORMAT_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Every field is converted through a 100-entry packed BCD table in flash, so
+ * formatting costs a table read and two adds per field, with no division and
+ * no printf. Build with -DRTC_FORMAT_SNPRINTF=1 to get the same functions
+ * on top of snprintf instead; that build only exists as the benchmark
+ * baseline (PROF_FORMAT with the profiler on, and the flash size).
+ */
+#ifndef RTC_FORMAT_SNPRINTF
+#define RTC_FORMAT_SNPRINTF 0
+#endif
+
+/* Buffer sizes, terminating null included */
+#define RTC_FORMAT_TIME_SIZE 9    // "HH:MM:SS"
+#define RTC_FORMAT_TIME12_SIZE 12 // "hh:mm:ss AM"
+#define RTC_FORMAT_DATE_SIZE 11   // "YYYY-MM-DD"
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Packed BCD of a two-digit number (tens in the high nibble).
+ * @param  value 0-99.
+ * @return The BCD byte, e.g. 0x42 for 42.
+ */
+unsigned char rtc_format_u8bcd(unsigned char value);
+
+/**
+ * @brief  Write a number as two characters with a leading zero (no null).
+ * @param  value 0-99.
+ * @param  text Buffer of at least 2 characters.
+ * @return None
+ */
+void rtc_format_vtwo_digits(unsigned char value, char *text);
+
+/**
+ * @brief  Write a time as "HH:MM:SS".
+ * @param  hours Hours as shown (0-23, or 1-12).
+ * @param  minutes Minutes (0-59).
+ * @param  seconds Seconds (0-59).
+ * @param  text Buffer of RTC_FORMAT_TIME_SIZE characters.
+ * @return None
+ */
+void rtc_format_vtime(unsigned char hours, unsigned char minutes,
+                      unsigned char seconds, char *text);
+
+/**
+ * @brief  Write a 24h time in 12h form as "hh:mm:ss AM" or "hh:mm:ss PM".
+ * @param  hours Hours in 24h form (0-23).
+ * @param  minutes Minutes (0-59).
+ * @param  seconds Seconds (0-59).
+ * @param  text Buffer of RTC_FORMAT_TIME12_SIZE characters.
+ * @return None
+ */
+void rtc_format_vtime12(unsigned char hours, unsigned char minutes,
+                        unsigned char seconds, char *text);
+
+/**
+ * @brief  Write a date as "YYYY-MM-DD".
+ * @param  year 2000-2099.
+ * @param  month 1-12.
+ * @param  day 1-31.
+ * @param  text Buffer of RTC_FORMAT_DATE_SIZE characters.
+ * @return None
+ */
+void rtc_format_vdate(unsigned int year, unsigned char month,
+                      unsigned char day, char *text);
+
+#endif /* RTC_FORMAT_H_ */
@@ -0,0 +1,50 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: simavr_trace.c
+ * Description: simavr firmware section for the pin-level timing traces
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "board_pinmap.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Build with -DSIMAVR_TRACE=1 to run the firmware in simavr with a VCD trace.
+ * The .mmcu section below tells simavr the part and clock, and to record
+ * every write to PORTA-PORTD and each entry of the Timer2 overflow ISR (the
+ * clock second) into rtc_trace.vcd. tools/vcd_timing_check.py checks the
+ * LCD bus timing, the display refresh and the second length in that trace.
+ * The section is not loaded into the part, so the image is unchanged.
+ */
+#ifndef SIMAVR_TRACE
+#define SIMAVR_TRACE 0
+#endif
+
+#if SIMAVR_TRACE
+#define F_CPU 8000000UL
+#include <simavr/avr/avr_mcu_section.h>
+
+/* Flush period of the trace file in microseconds */
+#define SIMAVR_TRACE_FLUSH_US 100000
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+AVR_MCU(F_CPU, "atmega32");
+AVR_MCU_VCD_FILE("rtc_trace.vcd", SIMAVR_TRACE_FLUSH_US);
+
+const struct avr_mmcu_vcd_trace_t simavr_trace_ports[] _MMCU_ = {
+    {AVR_MCU_VCD_SYMBOL("PORTA"), .what = (void *)&PORTA},
+    {AVR_MCU_VCD_SYMBOL("PORTB"), .what = (void *)&PORTB},
+    {AVR_MCU_VCD_SYMBOL("PORTC"), .what = (void *)&PORTC},
+    {AVR_MCU_VCD_SYMBOL("PORTD"), .what = (void *)&PORTD},
+};
+
+AVR_MCU_VCD_IRQ(TIMER2_OVF)
+#endif /* SIMAVR_TRACE */
@@ -0,0 +1,53 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: stack_check.c
+ * Description: Stack high-water mark from a painted free RAM area
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "stack_check.h"
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+/* Linker symbols: end of the static data, and the top of the stack */
+extern unsigned char _end;
+extern unsigned char __stack;
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Paint the free RAM. Placed in .init3, after the stack pointer is
+ *         set and before .data/.bss are set up; naked, so it uses no stack
+ *         and falls through to the next init section.
+ * @param  None
+ * @return None
+ */
+static void stack_vpaint(void)
+    __attribute__((naked, used, section(".init3")));
+static void stack_vpaint(void) {
+  unsigned char *byte = &_end;
+  while (byte <= &__stack) {
+    *byte++ = STACK_PAINT;
+  }
+}
+
+/**
+ * @brief  Bytes between the end of the static data and the deepest stack
+ *         use since the reset.
+ * @param  None
+ * @return The headroom in bytes.
+ */
+unsigned int stack_u16headroom(void) {
+  const unsigned char *byte = &_end;
+  while (byte <= &__stack && *byte == STACK_PAINT) {
+    byte++;
+  }
+  return (unsigned int)(byte - &_end);
+}
@@ -0,0 +1,36 @@
+/******************************************************************************
+ * Module: LIB
+ * File Name: stack_check.h
+ * Description: Stack high-water mark from a painted free RAM area
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef STACK_CHECK_H_
+#define STACK_CHECK_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Before the C start-up code runs, every byte from the end of the static
+ * data (.noinit included) to RAMEND is painted with STACK_PAINT. The stack
+ * grows down into that area and overwrites the paint, so the paint left
+ * at the bottom is the headroom that the deepest stack use so far did not
+ * reach. Every reset repaints.
+ */
+#define STACK_PAINT 0xC5
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Bytes between the end of the static data and the deepest stack
+ *         use since the reset. Scans the paint, ~6 cycles per free byte.
+ * @param  None
+ * @return The headroom in bytes; 0 means the stack reached the data.
+ */
+unsigned int stack_u16headroom(void);
+
+#endif /* STACK_CHECK_H_ */
@@ -0,0 +1,155 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: ADC.c
+ * Description: Source file for the interrupt-driven, oversampling ADC driver
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "ADC.h"
+#include "../../LIB/cpu_load.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* AVCC reference, right-adjusted result */
+#define ADC_REFERENCE (1 << REFS0)
+
+/* 8MHz / 64 = 125kHz ADC clock, 104us per conversion */
+#define ADC_PRESCALER ((1 << ADPS2) | (1 << ADPS1))
+
+/* Auto trigger source: timer0 compare match */
+#define ADC_TRIGGER ((1 << ADTS1) | (1 << ADTS0))
+#define ADC_TRIGGER_MASK ((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0))
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static unsigned char adc_channels[ADC_INPUTS_MAX];
+static unsigned char adc_count = 0;
+
+/* Written by the ISR only */
+static unsigned char adc_input = 0;      // input being converted
+static unsigned char adc_conversions = 0; // conversions of adc_input so far
+static unsigned int adc_sum = 0;
+
+/* Decimated samples of each input */
+static volatile unsigned int adc_history[ADC_INPUTS_MAX][ADC_HISTORY];
+static volatile unsigned char adc_head[ADC_INPUTS_MAX];
+static volatile unsigned char adc_filled[ADC_INPUTS_MAX];
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Start sampling the given inputs against AVCC. Conversions are
+ *         triggered by the timer0 compare match, which must be running with
+ *         its interrupt enabled (timer0_CTC_period_init_interrupt()).
+ * @param  channels ADC multiplexer channels (0-7, ADC_CHANNEL_BANDGAP).
+ * @param  count Number of channels (1 to ADC_INPUTS_MAX).
+ * @return None
+ */
+void ADC_vInit(const unsigned char *channels, unsigned char count) {
+  unsigned char i;
+
+  if (count == 0 || count > ADC_INPUTS_MAX) {
+    return;
+  }
+  ADCSRA = 0; // stop while the inputs change
+  for (i = 0; i < count; i++) {
+    adc_channels[i] = channels[i];
+    adc_head[i] = 0;
+    adc_filled[i] = 0;
+  }
+  adc_count = count;
+  adc_input = 0;
+  adc_conversions = 0;
+  adc_sum = 0;
+
+  ADMUX = ADC_REFERENCE | adc_channels[0];
+  SFIOR = (SFIOR & ~ADC_TRIGGER_MASK) | ADC_TRIGGER;
+  ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADIF) |
+           ADC_PRESCALER; // writing ADIF clears a stale flag
+}
+
+/**
+ * @brief  Filtered reading of one input. Never waits for a conversion.
+ * @param  channel ADC multiplexer channel passed to ADC_vInit().
+ * @return 0 to ADC_FULL_SCALE, ADC_NO_DATA if there is no sample yet.
+ */
+unsigned int ADC_u16get_filtered(unsigned char channel) {
+  unsigned int total = 0;
+  unsigned char filled = 0;
+  unsigned char input;
+  unsigned char i;
+
+  for (input = 0; input < adc_count; input++) {
+    if (adc_channels[input] == channel) {
+      break;
+    }
+  }
+  if (input == adc_count) {
+    return ADC_NO_DATA;
+  }
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    filled = adc_filled[input];
+    for (i = 0; i < filled; i++) {
+      total += adc_history[input][i];
+    }
+  }
+  if (filled == 0) {
+    return ADC_NO_DATA;
+  }
+  return total / filled;
+}
+
+/**
+ * @brief  Supply voltage from the filtered bandgap reading.
+ * @param  None
+ * @return AVCC in millivolts, 0 if the bandgap is not sampled yet.
+ */
+unsigned int ADC_u16supply_mv(void) {
+  unsigned int bandgap = ADC_u16get_filtered(ADC_CHANNEL_BANDGAP);
+
+  if (bandgap == ADC_NO_DATA || bandgap == 0) {
+    return 0;
+  }
+  // bandgap / (FULL_SCALE + 1) = VBG / AVCC
+  return (unsigned int)(ADC_BANDGAP_MV * (ADC_FULL_SCALE + 1UL) / bandgap);
+}
+
+/**
+ * @brief  ADC Conversion Complete Interrupt Service Routine.
+ * @param  ADC_vect Interrupt vector.
+ * @return None
+ */
+ISR(ADC_vect) {
+  CPU_LOAD_ISR_BEGIN();
+  unsigned char input = adc_input;
+  // The first conversion after a channel change is discarded: the sample
+  // and hold (and the bandgap) need time to settle on the new input, and a
+  // trigger that lands before ADMUX is written still converts the old one.
+  if (adc_conversions++ != 0) {
+    adc_sum += ADC;
+  }
+  if (adc_conversions > ADC_OVERSAMPLE) {
+    adc_history[input][adc_head[input]] = adc_sum >> ADC_DECIMATE_SHIFT;
+    adc_head[input] = (adc_head[input] + 1) & (ADC_HISTORY - 1);
+    if (adc_filled[input] < ADC_HISTORY) {
+      adc_filled[input]++;
+    }
+    adc_sum = 0;
+    adc_conversions = 0;
+    input = (input + 1 < adc_count) ? input + 1 : 0;
+    adc_input = input;
+    ADMUX = ADC_REFERENCE | adc_channels[input];
+  }
+  CPU_LOAD_ISR_END(CPU_LOAD_ISR_ADC);
+}
@@ -0,0 +1,64 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: ADC.h
+ * Description: Header file for the interrupt-driven, oversampling ADC driver
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef ADC_H_
+#define ADC_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Conversions are auto-triggered by the timer0 compare match (the system
+ * tick), so sampling costs one short interrupt per tick and nothing in the
+ * main loop. The inputs are sampled in turn: ADC_OVERSAMPLE conversions of
+ * one input (after a discarded settling conversion) are summed and decimated
+ * to one 12-bit sample, which goes into a ring of ADC_HISTORY samples per
+ * input. ADC_u16get_filtered() returns the mean of that ring.
+ */
+#define ADC_INPUTS_MAX 4
+#define ADC_OVERSAMPLE 16     // conversions per sample, 4^2 for 2 extra bits
+#define ADC_DECIMATE_SHIFT 2  // 16 x 10 bits = 14 bits, decimated to 12 bits
+#define ADC_HISTORY 4         // samples averaged per input, power of 2
+#define ADC_FULL_SCALE 4095   // largest filtered value
+
+/* Returned while an input has no sample yet or is not sampled at all */
+#define ADC_NO_DATA 0xFFFF
+
+/* Internal 1.22V bandgap measured against AVCC gives the supply voltage */
+#define ADC_CHANNEL_BANDGAP 0x1E
+#define ADC_BANDGAP_MV 1220UL // typical, 1.15V-1.35V between parts
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Start sampling the given inputs against AVCC. Conversions are
+ *         triggered by the timer0 compare match, which must be running with
+ *         its interrupt enabled (timer0_CTC_period_init_interrupt()).
+ * @param  channels ADC multiplexer channels (0-7, ADC_CHANNEL_BANDGAP).
+ * @param  count Number of channels (1 to ADC_INPUTS_MAX).
+ * @return None
+ */
+void ADC_vInit(const unsigned char *channels, unsigned char count);
+
+/**
+ * @brief  Filtered reading of one input. Never waits for a conversion.
+ * @param  channel ADC multiplexer channel passed to ADC_vInit().
+ * @return 0 to ADC_FULL_SCALE, ADC_NO_DATA if there is no sample yet.
+ */
+unsigned int ADC_u16get_filtered(unsigned char channel);
+
+/**
+ * @brief  Supply voltage from the filtered bandgap reading.
+ * @param  None
+ * @return AVCC in millivolts, 0 if the bandgap is not sampled yet.
+ */
+unsigned int ADC_u16supply_mv(void);
+
+#endif /* ADC_H_ */
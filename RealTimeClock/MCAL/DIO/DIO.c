@@ -9,6 +9,7 @@
 /*******************************************************************************
  *                                  Includes                                   *
  *******************************************************************************/
+#include "DIO.h"
 #include "../../LIB/std_macros.h"
 #include <avr/io.h>
 
@@ -305,49 +306,110 @@ void DIO_vconnectpullup(char portname, char pinnumber, char connect_pullup) {
 }
 
 /**
- * @brief  Write a value to the low nibble of the port.
+ * @brief  Replace the bits of a register selected by a mask with one read
+ *         and one write. Interrupts are held off in between, so an ISR that
+ *         changes other bits of the same register is not undone.
+ * @param  reg The register (PORTx or DDRx).
+ * @param  mask The bits to change.
+ * @param  value The new value of those bits.
+ * @return None
+ */
+static void DIO_vwrite_reg_mask(volatile unsigned char *reg, unsigned char mask,
+                                unsigned char value) {
+  DIO_REG_WRITE_MASK(*reg, mask, value);
+}
+
+/**
+ * @brief  Write several pins of a port in one port access.
  * @param  portname The port name ('A', 'B', 'C', 'D').
- * @param  value The value to write (lower 4 bits).
+ * @param  mask The pins to write (1 = write).
+ * @param  value The levels of the pins in mask, other bits are ignored.
  * @return None
  */
-void write_low_nibble(unsigned char portname, unsigned char value) {
-  value &= 0x0f;
+void DIO_write_mask(unsigned char portname, unsigned char mask,
+                    unsigned char value) {
   switch (portname) {
   case 'A':
-    PORTA &= 0xf0;
-    PORTA |= value;
+    DIO_vwrite_reg_mask(&PORTA, mask, value);
+    break;
   case 'B':
-    PORTB &= 0xf0;
-    PORTB |= value;
+    DIO_vwrite_reg_mask(&PORTB, mask, value);
+    break;
   case 'C':
-    PORTC &= 0xf0;
-    PORTC |= value;
+    DIO_vwrite_reg_mask(&PORTC, mask, value);
+    break;
   case 'D':
-    PORTD &= 0xf0;
-    PORTD |= value;
+    DIO_vwrite_reg_mask(&PORTD, mask, value);
+    break;
+  default:
+    break;
   }
 }
 
 /**
- * @brief  Write a value to the high nibble of the port.
+ * @brief  Set the direction of several pins of a port in one access.
  * @param  portname The port name ('A', 'B', 'C', 'D').
- * @param  value The value to write (upper 4 bits).
+ * @param  mask The pins to configure (1 = configure).
+ * @param  direction The directions of the pins in mask (1 output, 0 input).
  * @return None
  */
-void write_high_nibble(unsigned char portname, unsigned char value) {
-  value <<= 4;
+void DIO_set_dir_mask(unsigned char portname, unsigned char mask,
+                      unsigned char direction) {
+  switch (portname) {
+  case 'A':
+    DIO_vwrite_reg_mask(&DDRA, mask, direction);
+    break;
+  case 'B':
+    DIO_vwrite_reg_mask(&DDRB, mask, direction);
+    break;
+  case 'C':
+    DIO_vwrite_reg_mask(&DDRC, mask, direction);
+    break;
+  case 'D':
+    DIO_vwrite_reg_mask(&DDRD, mask, direction);
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief  Read several pins of a port in one access.
+ * @param  portname The port name ('A', 'B', 'C', 'D').
+ * @param  mask The pins to read.
+ * @return The pin levels in their bit positions, 0 outside mask.
+ */
+unsigned char DIO_read_mask(unsigned char portname, unsigned char mask) {
   switch (portname) {
   case 'A':
-    PORTA &= 0x0f;
-    PORTA |= value;
+    return DIO_REG_READ_MASK(PINA, mask);
   case 'B':
-    PORTB &= 0x0f;
-    PORTB |= value;
+    return DIO_REG_READ_MASK(PINB, mask);
   case 'C':
-    PORTC &= 0x0f;
-    PORTC |= value;
+    return DIO_REG_READ_MASK(PINC, mask);
   case 'D':
-    PORTD &= 0x0f;
-    PORTD |= value;
+    return DIO_REG_READ_MASK(PIND, mask);
+  default:
+    return 0;
   }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief  Write a value to the low nibble of the port.
+ * @param  portname The port name ('A', 'B', 'C', 'D').
+ * @param  value The value to write (lower 4 bits).
+ * @return None
+ */
+void write_low_nibble(unsigned char portname, unsigned char value) {
+  DIO_write_mask(portname, 0x0f, value);
+}
+
+/**
+ * @brief  Write a value to the high nibble of the port.
+ * @param  portname The port name ('A', 'B', 'C', 'D').
+ * @param  value The value to write (upper 4 bits).
+ * @return None
+ */
+void write_high_nibble(unsigned char portname, unsigned char value) {
+  DIO_write_mask(portname, 0xf0, value << 4);
+}
@@ -9,6 +9,29 @@
 #ifndef DIO_H_
 #define DIO_H_
 
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include <util/atomic.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Masked access to a register known at compile time, for the drivers that
+ * take their ports from the board pin map. The write is one read and one
+ * write of the register with interrupts held off in between, so an ISR that
+ * updates other pins of the same port cannot be undone by it. Inside an ISR
+ * (interrupts already off) a plain read-modify-write is enough.
+ */
+#define DIO_REG_WRITE_MASK(reg, mask, value)                                   \
+  do {                                                                         \
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {                                        \
+      (reg) = ((reg) & (unsigned char)~(mask)) | ((value) & (mask));           \
+    }                                                                          \
+  } while (0)
+#define DIO_REG_READ_MASK(reg, mask) ((reg) & (mask))
+
 /*******************************************************************************
  *                       Software Interfaces Declarations                      *
  *******************************************************************************/
@@ -97,4 +120,32 @@ void write_low_nibble(unsigned char portname, unsigned char value);
  */
 void write_high_nibble(unsigned char portname, unsigned char value);
 
+/**
+ * @brief  Write several pins of a port in one port access.
+ * @param  portname The port name ('A', 'B', 'C', 'D').
+ * @param  mask The pins to write (1 = write).
+ * @param  value The levels of the pins in mask, other bits are ignored.
+ * @return None
+ */
+void DIO_write_mask(unsigned char portname, unsigned char mask,
+                    unsigned char value);
+
+/**
+ * @brief  Set the direction of several pins of a port in one access.
+ * @param  portname The port name ('A', 'B', 'C', 'D').
+ * @param  mask The pins to configure (1 = configure).
+ * @param  direction The directions of the pins in mask (1 output, 0 input).
+ * @return None
+ */
+void DIO_set_dir_mask(unsigned char portname, unsigned char mask,
+                      unsigned char direction);
+
+/**
+ * @brief  Read several pins of a port in one access.
+ * @param  portname The port name ('A', 'B', 'C', 'D').
+ * @param  mask The pins to read.
+ * @return The pin levels in their bit positions, 0 outside mask.
+ */
+unsigned char DIO_read_mask(unsigned char portname, unsigned char mask);
+
 #endif /* DIO_H_ */
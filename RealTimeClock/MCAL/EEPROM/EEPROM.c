@@ -0,0 +1,108 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: EEPROM.c
+ * Description: Source file for the interrupt-driven EEPROM driver
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "EEPROM.h"
+#include "../../LIB/cpu_load.h"
+#include "../../LIB/std_macros.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static unsigned char eeprom_buffer[EEPROM_WRITE_BUFFER_SIZE];
+static volatile unsigned int eeprom_address;
+static volatile unsigned char eeprom_index;
+static volatile unsigned char eeprom_length;
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Check whether a background write is still running.
+ * @param  None
+ * @return 1 if busy, 0 if idle.
+ */
+unsigned char EEPROM_u8is_busy(void) {
+  return READ_BIT(EECR, EERIE) | READ_BIT(EECR, EEWE);
+}
+
+/**
+ * @brief  Read a block from the EEPROM. Waits for a pending write to finish.
+ * @param  address The first EEPROM address.
+ * @param  data Pointer to store the bytes.
+ * @param  length Number of bytes to read.
+ * @return None
+ */
+void EEPROM_vread_block(unsigned int address, unsigned char *data,
+                        unsigned char length) {
+  while (EEPROM_u8is_busy())
+    ;
+  while (length--) {
+    EEAR = address++;
+    SET_BIT(EECR, EERE);
+    *data++ = EEDR;
+  }
+}
+
+/**
+ * @brief  Start writing a block in the background.
+ * @param  address The first EEPROM address.
+ * @param  data Pointer to the bytes to write.
+ * @param  length Number of bytes (1 to EEPROM_WRITE_BUFFER_SIZE).
+ * @return 1 if the write was started, 0 if a write is pending or the block is
+ * too large.
+ */
+unsigned char EEPROM_u8write_block_async(unsigned int address,
+                                         const unsigned char *data,
+                                         unsigned char length) {
+  unsigned char i;
+  if (EEPROM_u8is_busy() || length == 0 ||
+      length > EEPROM_WRITE_BUFFER_SIZE) {
+    return 0;
+  }
+  for (i = 0; i < length; i++) {
+    eeprom_buffer[i] = data[i];
+  }
+  eeprom_address = address;
+  eeprom_index = 0;
+  eeprom_length = length;
+  /* EE_RDY fires right away since no write is in progress */
+  SET_BIT(EECR, EERIE);
+  return 1;
+}
+
+/**
+ * @brief  EEPROM Ready Interrupt Service Routine. Programs the next byte that
+ * differs from the stored value and disables itself when the block is done.
+ * @param  EE_RDY_vect Interrupt vector.
+ * @return None
+ */
+ISR(EE_RDY_vect) {
+  CPU_LOAD_ISR_BEGIN();
+  while (eeprom_index < eeprom_length) {
+    EEAR = eeprom_address + eeprom_index;
+    SET_BIT(EECR, EERE);
+    if (EEDR != eeprom_buffer[eeprom_index]) {
+      EEDR = eeprom_buffer[eeprom_index];
+      eeprom_index++;
+      /* EEWE must follow EEMWE within four cycles (interrupts are off here) */
+      SET_BIT(EECR, EEMWE);
+      SET_BIT(EECR, EEWE);
+      CPU_LOAD_ISR_END(CPU_LOAD_ISR_EEPROM);
+      return;
+    }
+    eeprom_index++;
+  }
+  CLR_BIT(EECR, EERIE);
+  CPU_LOAD_ISR_END(CPU_LOAD_ISR_EEPROM);
+}
@@ -0,0 +1,53 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: EEPROM.h
+ * Description: Header file for the interrupt-driven EEPROM driver
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Largest block accepted by one asynchronous write */
+#define EEPROM_WRITE_BUFFER_SIZE 16
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Read a block from the EEPROM. Waits for a pending write to finish.
+ * @param  address The first EEPROM address.
+ * @param  data Pointer to store the bytes.
+ * @param  length Number of bytes to read.
+ * @return None
+ */
+void EEPROM_vread_block(unsigned int address, unsigned char *data,
+                        unsigned char length);
+
+/**
+ * @brief  Start writing a block in the background. The bytes are copied, one
+ * byte is programmed per EE_RDY interrupt and bytes that already hold the
+ * value are skipped, so the caller never waits for the ~8.5ms byte writes.
+ * @param  address The first EEPROM address.
+ * @param  data Pointer to the bytes to write.
+ * @param  length Number of bytes (1 to EEPROM_WRITE_BUFFER_SIZE).
+ * @return 1 if the write was started, 0 if a write is pending or the block is
+ * too large.
+ */
+unsigned char EEPROM_u8write_block_async(unsigned int address,
+                                         const unsigned char *data,
+                                         unsigned char length);
+
+/**
+ * @brief  Check whether a background write is still running.
+ * @param  None
+ * @return 1 if busy, 0 if idle.
+ */
+unsigned char EEPROM_u8is_busy(void);
+
+#endif /* EEPROM_H_ */
@@ -0,0 +1,121 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: SPI.c
+ * Description: Source file for the interrupt-driven SPI master
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "SPI.h"
+#include "../../LIB/cpu_load.h"
+#include "../../LIB/std_macros.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Fixed SPI pins of the ATmega32 on port B */
+#define SPI_SS 4
+#define SPI_MOSI 5
+#define SPI_SCK 7
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static const unsigned char *spi_data;
+static unsigned char spi_length;
+static unsigned char spi_index; // next byte to send
+static volatile unsigned char spi_busy = 0;
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Initialize the SPI as a master, mode 0, MSB first, at F_CPU / 2.
+ * @param  None
+ * @return None
+ */
+void SPI_vInit(void) {
+  SET_BIT(PORTB, SPI_SS); // idle high, before it becomes an output
+  DDRB |= (1 << SPI_SS) | (1 << SPI_MOSI) | (1 << SPI_SCK);
+  SPCR = (1 << SPIE) | (1 << SPE) | (1 << MSTR);
+  SPSR = (1 << SPI2X);
+}
+
+/**
+ * @brief  Start sending a block; the SPI interrupt sends the rest.
+ * @param  data Pointer to the bytes, kept unchanged until the end.
+ * @param  length Number of bytes, at least 1.
+ * @return 1 if started, 0 if a transfer is still running.
+ */
+unsigned char SPI_u8start(const unsigned char *data, unsigned char length) {
+  if (spi_busy) {
+    return 0;
+  }
+  spi_data = data;
+  spi_length = length;
+  spi_index = 1;
+  spi_busy = 1;
+  CLR_BIT(PORTB, SPI_SS);
+  SPDR = data[0];
+  return 1;
+}
+
+/**
+ * @brief  Check whether a transfer is running.
+ * @param  None
+ * @return 1 if busy, 0 if idle.
+ */
+unsigned char SPI_u8is_busy(void) { return spi_busy; }
+
+/**
+ * @brief  Send the next byte, or end the transfer after the last one
+ *         (ISR context, or polled by SPI_vflush()).
+ * @param  None
+ * @return None
+ */
+static void spi_vnext(void) {
+  if (!spi_busy) {
+    return;
+  }
+  if (spi_index < spi_length) {
+    SPDR = spi_data[spi_index++];
+  } else {
+    (void)SPDR; // clears SPIF when polled
+    SET_BIT(PORTB, SPI_SS); // rising edge latches the shift registers
+    spi_busy = 0;
+  }
+}
+
+/**
+ * @brief  Finish the running transfer by polling.
+ * @param  None
+ * @return None
+ */
+void SPI_vflush(void) {
+  // the ISR must not take SPIF (and clear it) between the poll and the step
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    while (spi_busy) {
+      while (IS_BIT_CLR(SPSR, SPIF) && spi_busy) {
+      }
+      spi_vnext();
+    }
+  }
+}
+
+/**
+ * @brief  SPI Transfer Complete Interrupt Service Routine, one byte per call.
+ * @param  SPI_STC_vect Interrupt vector.
+ * @return None
+ */
+ISR(SPI_STC_vect) {
+  CPU_LOAD_ISR_BEGIN();
+  spi_vnext();
+  CPU_LOAD_ISR_END(CPU_LOAD_ISR_SPI);
+}
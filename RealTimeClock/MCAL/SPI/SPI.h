@@ -0,0 +1,51 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: SPI.h
+ * Description: Header file for the interrupt-driven SPI master
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef SPI_H_
+#define SPI_H_
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Initialize the SPI as a master, mode 0, MSB first, at F_CPU / 2.
+ *         MOSI (PB5), SCK (PB7) and SS (PB4) become outputs; SS idles high
+ *         and is low for the length of each transfer, so its rising edge
+ *         latches chained shift registers.
+ * @param  None
+ * @return None
+ */
+void SPI_vInit(void);
+
+/**
+ * @brief  Start sending a block; the SPI interrupt sends the rest. The bytes
+ *         are not copied: the caller keeps them unchanged until
+ *         SPI_u8is_busy() returns 0.
+ * @param  data Pointer to the bytes, the first one is shifted out first.
+ * @param  length Number of bytes, at least 1.
+ * @return 1 if started, 0 if a transfer is still running.
+ */
+unsigned char SPI_u8start(const unsigned char *data, unsigned char length);
+
+/**
+ * @brief  Check whether a transfer is running.
+ * @param  None
+ * @return 1 if busy, 0 if idle.
+ */
+unsigned char SPI_u8is_busy(void);
+
+/**
+ * @brief  Finish the running transfer by polling, with interrupts held
+ *         off meanwhile (start-up code that needs the bytes latched now).
+ * @param  None
+ * @return None
+ */
+void SPI_vflush(void);
+
+#endif /* SPI_H_ */
@@ -0,0 +1,175 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: TWI.c
+ * Description: Source file for the interrupt-driven TWI (I2C) master
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "TWI.h"
+#include "../../LIB/cpu_load.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+#include <util/twi.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define F_CPU 8000000UL
+#define TWI_TWBR ((F_CPU / TWI_SCL_HZ - 16) / 2)
+
+#if TWI_TWBR > 255 || TWI_TWBR < 10
+#error "TWI.h: TWI_SCL_HZ out of range for the bit rate register"
+#endif
+
+/* TWCR values: interrupt enabled, clear TWINT to go on */
+#define TWI_GO ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+#define TWI_START (TWI_GO | (1 << TWSTA))
+#define TWI_STOP ((1 << TWINT) | (1 << TWEN) | (1 << TWSTO))
+#define TWI_STOP_START (TWI_START | (1 << TWSTO)) // STOP, then a new START
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static twi_transaction_t *volatile twi_queue[TWI_QUEUE_SIZE];
+static volatile unsigned char twi_head = 0; // written by the application
+static volatile unsigned char twi_tail = 0; // written by the ISR
+
+/* Progress of the transaction at the tail, ISR only */
+static unsigned char twi_index; // next byte to send or receive
+static unsigned char twi_reading;
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Initialize the TWI as a bus master at TWI_SCL_HZ.
+ * @param  None
+ * @return None
+ */
+void TWI_vInit(void) {
+  TWSR = 0; // prescaler 1
+  TWBR = (unsigned char)TWI_TWBR;
+  TWCR = (1 << TWEN);
+}
+
+/**
+ * @brief  Queue a transaction.
+ * @param  transaction Pointer to the transaction.
+ * @return 1 if queued, 0 if the queue is full.
+ */
+unsigned char TWI_u8submit(twi_transaction_t *transaction) {
+  unsigned char next;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    next = (twi_head + 1) & (TWI_QUEUE_SIZE - 1);
+    if (next == twi_tail) {
+      return 0;
+    }
+    transaction->status = TWI_PENDING;
+    twi_queue[twi_head] = transaction;
+    if (twi_head == twi_tail) {
+      TWCR = TWI_START; // the bus was idle
+    }
+    twi_head = next;
+  }
+  return 1;
+}
+
+/**
+ * @brief  Check whether a transaction is queued or on the bus.
+ * @param  None
+ * @return 1 if busy, 0 if idle.
+ */
+unsigned char TWI_u8is_busy(void) { return twi_head != twi_tail; }
+
+/**
+ * @brief  Drop every queued transaction and restart the TWI.
+ * @param  None
+ * @return None
+ */
+void TWI_vreset(void) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TWCR = 0; // releases SCL and SDA
+    while (twi_tail != twi_head) {
+      twi_queue[twi_tail]->status = TWI_ERROR;
+      twi_tail = (twi_tail + 1) & (TWI_QUEUE_SIZE - 1);
+    }
+    TWCR = (1 << TWEN);
+  }
+}
+
+/**
+ * @brief  End the transaction at the tail and start the next one, if any
+ *         (ISR context).
+ * @param  status TWI_* result.
+ * @return None
+ */
+static void twi_vfinish(unsigned char status) {
+  twi_queue[twi_tail]->status = status;
+  twi_tail = (twi_tail + 1) & (TWI_QUEUE_SIZE - 1);
+  TWCR = (twi_tail != twi_head) ? TWI_STOP_START : TWI_STOP;
+}
+
+/**
+ * @brief  TWI Interrupt Service Routine, one bus event per call.
+ * @param  TWI_vect Interrupt vector.
+ * @return None
+ */
+ISR(TWI_vect) {
+  CPU_LOAD_ISR_BEGIN();
+  twi_transaction_t *transaction = twi_queue[twi_tail];
+
+  switch (TW_STATUS) {
+  case TW_START:
+    twi_index = 0;
+    twi_reading = (transaction->tx_length == 0);
+    TWDR = (transaction->address << 1) | (twi_reading ? TW_READ : TW_WRITE);
+    TWCR = TWI_GO;
+    break;
+  case TW_REP_START:
+    twi_index = 0;
+    twi_reading = 1;
+    TWDR = (transaction->address << 1) | TW_READ;
+    TWCR = TWI_GO;
+    break;
+  case TW_MT_SLA_ACK:
+  case TW_MT_DATA_ACK:
+    if (twi_index < transaction->tx_length) {
+      TWDR = transaction->tx[twi_index++];
+      TWCR = TWI_GO;
+    } else if (transaction->rx_length != 0) {
+      TWCR = TWI_START; // repeated start for the read part
+    } else {
+      twi_vfinish(TWI_DONE);
+    }
+    break;
+  case TW_MR_SLA_ACK:
+    // acknowledge every byte but the last
+    TWCR = TWI_GO | ((transaction->rx_length > 1) ? (1 << TWEA) : 0);
+    break;
+  case TW_MR_DATA_ACK:
+    transaction->rx[twi_index++] = TWDR;
+    TWCR = TWI_GO | ((twi_index + 1 < transaction->rx_length) ? (1 << TWEA)
+                                                               : 0);
+    break;
+  case TW_MR_DATA_NACK:
+    transaction->rx[twi_index] = TWDR; // the last byte
+    twi_vfinish(TWI_DONE);
+    break;
+  case TW_MT_SLA_NACK:
+  case TW_MT_DATA_NACK:
+  case TW_MR_SLA_NACK:
+    twi_vfinish(TWI_NACK);
+    break;
+  default: // bus error or lost arbitration (single master: a glitch)
+    twi_vfinish(TWI_ERROR);
+    break;
+  }
+  CPU_LOAD_ISR_END(CPU_LOAD_ISR_TWI);
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: TWI.h
+ * Description: Header file for the interrupt-driven TWI (I2C) master
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef TWI_H_
+#define TWI_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* SCL rate; TWBR = (F_CPU / TWI_SCL_HZ - 16) / 2 = 32 at 8MHz */
+#define TWI_SCL_HZ 100000UL
+
+/* Transactions waiting for the bus, must be a power of two */
+#define TWI_QUEUE_SIZE 4
+
+/* Transaction states */
+#define TWI_PENDING 0 // queued or on the bus
+#define TWI_DONE 1
+#define TWI_NACK 2  // no device at the address, or a byte refused
+#define TWI_ERROR 3 // bus error, lost arbitration or TWI_vreset()
+
+/*******************************************************************************
+ *                              Types Declaration                              *
+ *******************************************************************************/
+/* One transfer: tx_length bytes written, then (after a repeated start)
+ * rx_length bytes read. Either part may be empty. The caller owns the
+ * struct and the buffers until the status leaves TWI_PENDING. */
+typedef struct {
+  unsigned char address; // 7-bit slave address
+  const unsigned char *tx;
+  unsigned char tx_length;
+  unsigned char *rx;
+  unsigned char rx_length;
+  volatile unsigned char status; // TWI_*
+} twi_transaction_t;
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Initialize the TWI as a bus master at TWI_SCL_HZ. The SCL/SDA
+ *         pull-ups are on the board.
+ * @param  None
+ * @return None
+ */
+void TWI_vInit(void);
+
+/**
+ * @brief  Queue a transaction. The TWI interrupt runs it once the ones
+ *         before it are done, so the caller never waits for the bus.
+ * @param  transaction Pointer to the transaction; its status is set to
+ *         TWI_PENDING.
+ * @return 1 if queued, 0 if the queue is full.
+ */
+unsigned char TWI_u8submit(twi_transaction_t *transaction);
+
+/**
+ * @brief  Check whether a transaction is queued or on the bus.
+ * @param  None
+ * @return 1 if busy, 0 if idle.
+ */
+unsigned char TWI_u8is_busy(void);
+
+/**
+ * @brief  Drop every queued transaction (status TWI_ERROR) and restart the
+ *         TWI, e.g. after a slave held the bus for too long.
+ * @param  None
+ * @return None
+ */
+void TWI_vreset(void);
+
+#endif /* TWI_H_ */
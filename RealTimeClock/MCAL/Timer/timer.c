@@ -12,6 +12,7 @@
 #include "../../LIB/std_macros.h"
 #include <avr/interrupt.h>
 #include <avr/io.h>
+#include <util/atomic.h>
 
 
 /*******************************************************************************
@@ -52,6 +53,81 @@ void timer_CTC_init_interrupt(void) {
   SET_BIT(TIMSK, OCIE0);
 }
 
+/**
+ * @brief  Initialize the interrupt of the CTC mode of timer0 with a clk/64
+ * prescaler and the given compare value.
+ * @param  compare_value Value loaded in OCR0; the interrupt period is
+ * (compare_value + 1) * 64 CPU cycles.
+ * @return None
+ */
+void timer0_CTC_period_init_interrupt(unsigned char compare_value) {
+  /* select CTC mode*/
+  SET_BIT(TCCR0, WGM01);
+  /* load the period in OCR0 */
+  OCR0 = compare_value;
+  /* select timer clock clk/64 */
+  SET_BIT(TCCR0, CS00);
+  SET_BIT(TCCR0, CS01);
+  /* enable interrupt*/
+  sei();
+  SET_BIT(TIMSK, OCIE0);
+}
+
+/**
+ * @brief  Change the compare value of timer0 (the period of the next CTC
+ *         cycle when called from the compare ISR).
+ * @param  compare_value The new OCR0 value.
+ * @return None
+ */
+void timer0_set_compare(unsigned char compare_value) { OCR0 = compare_value; }
+
+/**
+ * @brief  Start timer1 as a free-running counter on the CPU clock.
+ * @param  None
+ * @return None
+ */
+void timer1_free_running_init(void) {
+  /* normal mode, no prescaler */
+  TCCR1A = 0;
+  TCCR1B = (1 << CS10);
+}
+
+/**
+ * @brief  Read the free-running timer1 counter.
+ * @param  None
+ * @return The current TCNT1 value (one count per CPU cycle).
+ */
+unsigned int timer1_u16read(void) {
+  unsigned int count;
+  /* the 16-bit read goes through the shared TEMP register */
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { count = TCNT1; }
+  return count;
+}
+
+/**
+ * @brief  Timestamp rising edges on ICP1 into ICR1 and enable the capture
+ *         and overflow interrupts. Timer1 keeps running free on the CPU
+ *         clock; the noise canceler adds a constant 4 cycle delay.
+ * @param  None
+ * @return None
+ */
+void timer1_capture_init_interrupt(void) {
+  /* normal mode, no prescaler, rising edge, noise canceler */
+  TCCR1B = (1 << ICNC1) | (1 << ICES1) | (1 << CS10);
+  /* drop stale events, then enable both interrupts */
+  TIFR = (1 << ICF1) | (1 << TOV1);
+  TIMSK |= (1 << TICIE1) | (1 << TOIE1);
+}
+
+/**
+ * @brief  Disable the timer1 capture and overflow interrupts.
+ * @param  None
+ * @return None
+ */
+void timer1_capture_stop(void) {
+  TIMSK &= ~((1 << TICIE1) | (1 << TOIE1));
+}
+
 /**
  * @brief  Initialize the generation of a wave on OC0 pin in non PWM mode.
  * @param  None
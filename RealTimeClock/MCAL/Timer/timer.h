@@ -27,6 +27,53 @@ void timer2_overflow_init_interrupt(void);
  */
 void timer_CTC_init_interrupt(void);
 
+/**
+ * @brief  Initialize the interrupt of the CTC mode of timer0 with a clk/64
+ * prescaler and the given compare value.
+ * @param  compare_value Value loaded in OCR0; the interrupt period is
+ * (compare_value + 1) * 64 CPU cycles.
+ * @return None
+ */
+void timer0_CTC_period_init_interrupt(unsigned char compare_value);
+
+/**
+ * @brief  Change the compare value of timer0 (the period of the next CTC
+ *         cycle when called from the compare ISR).
+ * @param  compare_value The new OCR0 value.
+ * @return None
+ */
+void timer0_set_compare(unsigned char compare_value);
+
+/**
+ * @brief  Start timer1 as a free-running counter on the CPU clock.
+ * @param  None
+ * @return None
+ */
+void timer1_free_running_init(void);
+
+/**
+ * @brief  Read the free-running timer1 counter.
+ * @param  None
+ * @return The current TCNT1 value (one count per CPU cycle).
+ */
+unsigned int timer1_u16read(void);
+
+/**
+ * @brief  Timestamp rising edges on ICP1 into ICR1 and enable the capture
+ *         and overflow interrupts. Timer1 keeps running free on the CPU
+ *         clock; the noise canceler adds a constant 4 cycle delay.
+ * @param  None
+ * @return None
+ */
+void timer1_capture_init_interrupt(void);
+
+/**
+ * @brief  Disable the timer1 capture and overflow interrupts.
+ * @param  None
+ * @return None
+ */
+void timer1_capture_stop(void);
+
 /**
  * @brief  Initialize the generation of a wave on OC0 pin in non PWM mode.
  * @param  None
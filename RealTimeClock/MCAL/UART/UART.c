@@ -0,0 +1,132 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: UART.c
+ * Description: Source file for the interrupt-driven UART transmitter
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "UART.h"
+#include "../../LIB/cpu_load.h"
+#include "../../LIB/std_macros.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define F_CPU 8000000UL
+#define UART_UBRR ((F_CPU / (16UL * UART_BAUD)) - 1)
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+static char uart_tx_buffer[UART_TX_BUFFER_SIZE];
+static volatile unsigned char uart_tx_head = 0; // written by the application
+static volatile unsigned char uart_tx_tail = 0; // written by the ISR
+static unsigned char uart_tx_fill; // end of the block being put
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Initialize the UART for transmission at UART_BAUD.
+ * @param  None
+ * @return None
+ */
+void UART_vInit(void) {
+  UBRRH = (unsigned char)(UART_UBRR >> 8);
+  UBRRL = (unsigned char)UART_UBRR;
+  UCSRB = (1 << TXEN);
+  UCSRC = (1 << URSEL) | (1 << UCSZ1) | (1 << UCSZ0); // 8 data bits, 1 stop
+}
+
+/**
+ * @brief  Queue one byte for transmission. Waits for room if the buffer is
+ *         full, so it must not be called with interrupts disabled.
+ * @param  data The byte to send.
+ * @return None
+ */
+void UART_vsend_char(char data) {
+  unsigned char next = (uart_tx_head + 1) & (UART_TX_BUFFER_SIZE - 1);
+  while (next == uart_tx_tail)
+    ; // buffer full, the UDRE interrupt is draining it
+  uart_tx_buffer[uart_tx_head] = data;
+  uart_tx_head = next;
+  SET_BIT(UCSRB, UDRIE);
+}
+
+/**
+ * @brief  Queue a null-terminated string for transmission.
+ * @param  data Pointer to the string.
+ * @return None
+ */
+void UART_vsend_string(const char *data) {
+  while (*data != '\0') {
+    UART_vsend_char(*data);
+    data++;
+  }
+}
+
+/**
+ * @brief  Room left in the transmit buffer, so a caller can queue a block
+ *         without waiting.
+ * @param  None
+ * @return Number of bytes UART_vsend_char() accepts without waiting.
+ */
+unsigned char UART_u8tx_free(void) {
+  return (uart_tx_tail - uart_tx_head - 1) & (UART_TX_BUFFER_SIZE - 1);
+}
+
+/**
+ * @brief  Reserve room for a block in the transmit buffer.
+ * @param  length Number of bytes the block will have.
+ * @return 1 if the room is there, 0 if the buffer is too full.
+ */
+unsigned char UART_u8tx_begin(unsigned char length) {
+  if (UART_u8tx_free() < length) {
+    return 0;
+  }
+  uart_tx_fill = uart_tx_head;
+  return 1;
+}
+
+/**
+ * @brief  Put the next byte of the reserved block.
+ * @param  data The byte.
+ * @return None
+ */
+void UART_vtx_put(unsigned char data) {
+  uart_tx_buffer[uart_tx_fill] = (char)data;
+  uart_tx_fill = (uart_tx_fill + 1) & (UART_TX_BUFFER_SIZE - 1);
+}
+
+/**
+ * @brief  Hand the bytes put since UART_u8tx_begin() to the transmitter.
+ * @param  None
+ * @return None
+ */
+void UART_vtx_commit(void) {
+  uart_tx_head = uart_tx_fill; // one byte store: the ISR sees all or none
+  SET_BIT(UCSRB, UDRIE);
+}
+
+/**
+ * @brief  USART Data Register Empty Interrupt Service Routine.
+ * @param  USART_UDRE_vect Interrupt vector.
+ * @return None
+ */
+ISR(USART_UDRE_vect) {
+  CPU_LOAD_ISR_BEGIN();
+  if (uart_tx_tail == uart_tx_head) {
+    CLR_BIT(UCSRB, UDRIE); // nothing left to send
+  } else {
+    UDR = uart_tx_buffer[uart_tx_tail];
+    uart_tx_tail = (uart_tx_tail + 1) & (UART_TX_BUFFER_SIZE - 1);
+  }
+  CPU_LOAD_ISR_END(CPU_LOAD_ISR_UART);
+}
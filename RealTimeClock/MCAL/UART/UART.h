@@ -0,0 +1,82 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: UART.h
+ * Description: Header file for the interrupt-driven UART transmitter
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef UART_H_
+#define UART_H_
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* 38400 8N1; UBRR = 12 at 8MHz, 0.2% error */
+#define UART_BAUD 38400UL
+
+/* Transmit ring buffer, must be a power of two */
+#define UART_TX_BUFFER_SIZE 64
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Initialize the UART for transmission at UART_BAUD.
+ * @param  None
+ * @return None
+ */
+void UART_vInit(void);
+
+/**
+ * @brief  Queue one byte for transmission. Waits for room if the buffer is
+ *         full, so it must not be called with interrupts disabled.
+ * @param  data The byte to send.
+ * @return None
+ */
+void UART_vsend_char(char data);
+
+/**
+ * @brief  Queue a null-terminated string for transmission.
+ * @param  data Pointer to the string.
+ * @return None
+ */
+void UART_vsend_string(const char *data);
+
+/**
+ * @brief  Room left in the transmit buffer, so a caller can queue a block
+ *         without waiting.
+ * @param  None
+ * @return Number of bytes UART_vsend_char() accepts without waiting.
+ */
+unsigned char UART_u8tx_free(void);
+
+/*
+ * A block can also be written straight into the transmit buffer: reserve
+ * its room, put its bytes, then commit it. Nothing of it is sent before the
+ * commit; no other UART call may come in between.
+ */
+
+/**
+ * @brief  Reserve room for a block in the transmit buffer.
+ * @param  length Number of bytes the block will have.
+ * @return 1 if the room is there, 0 if the buffer is too full (try later).
+ */
+unsigned char UART_u8tx_begin(unsigned char length);
+
+/**
+ * @brief  Put the next byte of the reserved block.
+ * @param  data The byte.
+ * @return None
+ */
+void UART_vtx_put(unsigned char data);
+
+/**
+ * @brief  Hand the bytes put since UART_u8tx_begin() to the transmitter.
+ * @param  None
+ * @return None
+ */
+void UART_vtx_commit(void);
+
+#endif /* UART_H_ */
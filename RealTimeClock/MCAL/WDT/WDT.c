@@ -0,0 +1,46 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: WDT.c
+ * Description: Source file for the Watchdog and reset cause driver
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include "WDT.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                             Functions Definitions                           *
+ *******************************************************************************/
+
+/**
+ * @brief  Read and clear the reset cause flags. Call once at boot.
+ * @param  None
+ * @return The WDT_RESET_* flags of the last reset.
+ */
+unsigned char WDT_u8reset_cause(void) {
+  unsigned char cause = MCUCSR & (WDT_RESET_POWER_ON | WDT_RESET_EXTERNAL |
+                                  WDT_RESET_BROWN_OUT | WDT_RESET_WATCHDOG |
+                                  WDT_RESET_JTAG);
+  /* flags are cleared by writing zero; JTD and ISC2 keep their value */
+  MCUCSR &= ~(WDT_RESET_POWER_ON | WDT_RESET_EXTERNAL | WDT_RESET_BROWN_OUT |
+              WDT_RESET_WATCHDOG | WDT_RESET_JTAG);
+  return cause;
+}
+
+/**
+ * @brief  Enable the watchdog with WDT_TIMEOUT.
+ * @param  None
+ * @return None
+ */
+void WDT_vInit(void) { wdt_enable(WDT_TIMEOUT); }
+
+/**
+ * @brief  Restart the watchdog period.
+ * @param  None
+ * @return None
+ */
+void WDT_vfeed(void) { wdt_reset(); }
@@ -0,0 +1,55 @@
+/******************************************************************************
+ * Module: MCAL
+ * File Name: WDT.h
+ * Description: Header file for the Watchdog and reset cause driver
+ * Author: Abdelrahman Arafa
+ * Email: engarafa55@gmail.com
+ ******************************************************************************/
+
+#ifndef WDT_H_
+#define WDT_H_
+
+/*******************************************************************************
+ *                                  Includes                                   *
+ *******************************************************************************/
+#include <avr/wdt.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Watchdog period; the main dispatch loop must come around within it */
+#define WDT_TIMEOUT WDTO_500MS
+
+/* Reset causes as returned by WDT_u8reset_cause() (MCUCSR flags) */
+#define WDT_RESET_POWER_ON (1 << PORF)
+#define WDT_RESET_EXTERNAL (1 << EXTRF)
+#define WDT_RESET_BROWN_OUT (1 << BORF)
+#define WDT_RESET_WATCHDOG (1 << WDRF)
+#define WDT_RESET_JTAG (1 << JTRF)
+
+/*******************************************************************************
+ *                       Software Interfaces Declarations                      *
+ *******************************************************************************/
+
+/**
+ * @brief  Read and clear the reset cause flags. Call once at boot.
+ * @param  None
+ * @return The WDT_RESET_* flags of the last reset.
+ */
+unsigned char WDT_u8reset_cause(void);
+
+/**
+ * @brief  Enable the watchdog with WDT_TIMEOUT.
+ * @param  None
+ * @return None
+ */
+void WDT_vInit(void);
+
+/**
+ * @brief  Restart the watchdog period.
+ * @param  None
+ * @return None
+ */
+void WDT_vfeed(void);
+
+#endif /* WDT_H_ */
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Decode an event log dump sent by the clock (diagnostics page 6, '=').
+
+Capture the serial port (38400 8N1) to a file and pass it, or read the
+port directly:
+
+    stty -F /dev/ttyUSB0 38400 raw && python3 tools/eventlog_decode.py /dev/ttyUSB0
+
+The frame layout is documented in RealTimeClock/APP/eventlog.h.
+"""
+
+import datetime
+import struct
+import sys
+
+MAGIC = b"\xe5L"
+VERSION = 1
+RECORD = struct.Struct("<IBBBB")  # time, type, payload, sequence, check
+EPOCH = datetime.datetime(2000, 1, 1)
+
+TYPES = {1: "reset", 2: "time-set", 3: "calib"}
+RESET_FLAGS = ["power-on", "external", "brown-out", "watchdog", "jtag"]
+SET_SOURCES = {0: "entry", 1: "adjust", 2: "rtc-chip"}
+CALIB_STATES = {3: "done", 4: "failed"}
+
+
+def crc8_ccitt(data, crc=0x5A):
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def crc_ccitt(data, crc=0xFFFF):
+    # avr-libc _crc_ccitt_update (reflected 0x8408)
+    for byte in data:
+        byte ^= crc & 0xFF
+        byte = (byte ^ (byte << 4)) & 0xFF
+        crc = ((byte << 8) | (crc >> 8)) ^ (byte >> 4) ^ (byte << 3)
+        crc &= 0xFFFF
+    return crc
+
+
+def describe(kind, payload):
+    if kind == 1:
+        flags = [name for bit, name in enumerate(RESET_FLAGS) if payload >> bit & 1]
+        return ",".join(flags) or "none"
+    if kind == 2:
+        return SET_SOURCES.get(payload, str(payload))
+    if kind == 3:
+        return CALIB_STATES.get(payload, str(payload))
+    return str(payload)
+
+
+def read_exact(stream, count):
+    data = b""
+    while len(data) < count:
+        chunk = stream.read(count - len(data))
+        if not chunk:
+            raise EOFError("dump ended early")
+        data += chunk
+    return data
+
+
+def decode(stream):
+    window = b""
+    while window != MAGIC:  # skip anything sent before the frame
+        byte = stream.read(1)
+        if not byte:
+            raise EOFError("no dump frame found")
+        window = (window + byte)[-2:]
+    header = MAGIC + read_exact(stream, 3)
+    version, count, dropped = header[2], header[3], header[4]
+    if version != VERSION:
+        raise ValueError("unknown dump version %d" % version)
+    body = read_exact(stream, count * RECORD.size)
+    (crc,) = struct.unpack("<H", read_exact(stream, 2))
+    if crc != crc_ccitt(header + body):
+        raise ValueError("frame CRC mismatch, the capture is damaged")
+
+    print("%d events, %d lost before reaching the EEPROM" % (count, dropped))
+    for offset in range(0, len(body), RECORD.size):
+        raw = body[offset:offset + RECORD.size]
+        seconds, kind, payload, sequence, check = RECORD.unpack(raw)
+        if check != crc8_ccitt(raw[:-1]) or kind == 0xFF:
+            print("  ---  invalid record (torn write)")
+            continue
+        stamp = EPOCH + datetime.timedelta(seconds=seconds)
+        print("  %3d  %s UTC  %-8s %s" % (sequence, stamp.isoformat(" "),
+                                         TYPES.get(kind, "type%d" % kind),
+                                         describe(kind, payload)))
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    with open(sys.argv[1], "rb") as stream:
+        try:
+            decode(stream)
+        except (EOFError, ValueError) as error:
+            sys.exit("eventlog_decode: %s" % error)
+
+
+if __name__ == "__main__":
+    main()
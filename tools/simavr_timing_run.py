@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Build the clock for simavr, run it and check the pin timing of the trace.
+
+Runs the sequence of the "Timing Checks in simavr" section of the README:
+
+    python3 tools/simavr_timing_run.py --board 1
+
+1. Compiles every .c of RealTimeClock with avr-gcc, -DSIMAVR_TRACE=1 and
+   the BOARD_PROFILE given, into a scratch directory.
+2. Runs the ELF in simavr for --run-seconds of wall time; simavr writes
+   rtc_trace.vcd next to it and flushes it when interrupted.
+3. Passes the trace to vcd_timing_check.py with the same board. Options
+   not known here (--allow-dim, --frame-tolerance ...) go to the checker.
+
+Exits with the status of the checker, or 2 if the build or the run fails.
+avr-gcc, avr-libc and simavr (with its headers) must be installed.
+"""
+
+import argparse
+import os
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FIRMWARE = os.path.join(os.path.dirname(HERE), "RealTimeClock")
+CHECKER = os.path.join(HERE, "vcd_timing_check.py")
+# The Release settings of RealTimeClock.cproj, plus the trace section
+CFLAGS = ["-mmcu=atmega32", "-Os", "-Wall", "-DNDEBUG", "-DSIMAVR_TRACE=1",
+          "-funsigned-char", "-funsigned-bitfields", "-fpack-struct",
+          "-fshort-enums"]
+
+
+def fail(text):
+    print("simavr_timing_run: " + text, file=sys.stderr)
+    sys.exit(2)
+
+
+def sources():
+    """Every translation unit of the firmware, as the .cproj compiles."""
+    found = []
+    for root, _, files in os.walk(FIRMWARE):
+        found += [os.path.join(root, f) for f in files if f.endswith(".c")]
+    return sorted(found)
+
+
+def build(cc, board, work):
+    elf = os.path.join(work, "RealTimeClock.elf")
+    command = [cc] + CFLAGS + ["-DBOARD_PROFILE=%d" % board] + sources() + \
+        ["-o", elf, "-lm"]
+    if subprocess.call(command) != 0:
+        fail("build failed")
+    return elf
+
+
+def run(simavr, elf, seconds, work):
+    process = subprocess.Popen([simavr, "-m", "atmega32", "-f", "8000000",
+                                elf], cwd=work)
+    try:
+        process.wait(seconds)
+        fail("simavr stopped by itself (status %d)" % process.returncode)
+    except subprocess.TimeoutExpired:
+        process.send_signal(signal.SIGINT)  # simavr flushes the trace
+        process.wait()
+    trace = os.path.join(work, "rtc_trace.vcd")
+    if not os.path.exists(trace):
+        fail("simavr wrote no rtc_trace.vcd")
+    return trace
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--board", type=int, default=1,
+                        help="BOARD_PROFILE to build and check")
+    parser.add_argument("--run-seconds", type=float, default=20,
+                        help="wall time to run the simulation")
+    parser.add_argument("--cc", default="avr-gcc", help="AVR compiler")
+    parser.add_argument("--simavr", default="simavr", help="simavr binary")
+    parser.add_argument("--keep", metavar="DIR",
+                        help="copy the ELF and the trace to DIR")
+    args, checker_args = parser.parse_known_args()
+
+    for tool in (args.cc, args.simavr):
+        if shutil.which(tool) is None:
+            fail("%s not found" % tool)
+    work = tempfile.mkdtemp(prefix="rtc_simavr_")
+    try:
+        elf = build(args.cc, args.board, work)
+        trace = run(args.simavr, elf, args.run_seconds, work)
+        if args.keep:
+            os.makedirs(args.keep, exist_ok=True)
+            shutil.copy(elf, args.keep)
+            shutil.copy(trace, args.keep)
+        status = subprocess.call([sys.executable, CHECKER, "--board",
+                                  str(args.board)] + checker_args + [trace])
+    finally:
+        shutil.rmtree(work)
+    sys.exit(status)
+
+
+if __name__ == "__main__":
+    main()
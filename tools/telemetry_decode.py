@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Decode the binary health telemetry sent by the clock.
+
+Boards with a serial port send one 26-byte record every TELEMETRY_PERIOD_S
+clock seconds (38400 8N1). Capture the port to a file and pass it, or read
+the port directly:
+
+    stty -F /dev/ttyUSB0 38400 raw && python3 tools/telemetry_decode.py /dev/ttyUSB0
+
+Records are found by their magic and kept only if the CRC matches, so
+anything else on the line (an event log dump, a profiler table) is
+skipped. The record layout is documented in RealTimeClock/APP/telemetry.h.
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+
+MAGIC = b"\xe5T"
+VERSION = 1
+# magic, version, sequence, time, uptime, trim, calib, reset cause,
+# cpu load, stack, refresh, keys, crc
+RECORD = struct.Struct("<HBBIIhBBHHHHH")
+EPOCH = datetime.datetime(2000, 1, 1)
+TRIM_SCALE = 16  # CLOCK_TRIM_SCALE, trim steps per ppm
+
+RESET_FLAGS = ["power-on", "external", "brown-out", "watchdog", "jtag"]
+CALIB_STATES = {0: "idle", 1: "running", 2: "measured", 3: "done",
+                4: "failed"}
+CSV_HEADER = ("sequence,utc,uptime_s,trim_ppm,calib,reset,cpu_load_pct,"
+              "stack_free,refresh_hz,keys")
+
+
+def crc_ccitt(data, crc=0xFFFF):
+    # avr-libc _crc_ccitt_update (reflected 0x8408)
+    for byte in data:
+        byte ^= crc & 0xFF
+        byte = (byte ^ (byte << 4)) & 0xFF
+        crc = ((byte << 8) | (crc >> 8)) ^ (byte >> 4) ^ (byte << 3)
+        crc &= 0xFFFF
+    return crc
+
+
+def records(stream):
+    """Yield the raw bytes of each record with a good CRC."""
+    window = b""
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            return
+        window += byte
+        start = window.find(MAGIC)
+        if start < 0:
+            window = window[-1:]
+            continue
+        window = window[start:]
+        if len(window) < RECORD.size:
+            continue
+        raw = window[:RECORD.size]
+        if raw[2] == VERSION and \
+                crc_ccitt(raw[:-2]) == struct.unpack("<H", raw[-2:])[0]:
+            window = window[RECORD.size:]
+            yield raw
+        else:
+            window = window[1:]  # a magic inside other data: look further
+
+
+def fields(raw):
+    (_, _, sequence, seconds, uptime, trim, calib, reset, load, stack,
+     refresh, keys, _) = RECORD.unpack(raw)
+    flags = [name for bit, name in enumerate(RESET_FLAGS) if reset >> bit & 1]
+    return {
+        "sequence": sequence,
+        "utc": (EPOCH + datetime.timedelta(seconds=seconds)).isoformat(" "),
+        "uptime": uptime,
+        "trim": trim / TRIM_SCALE,
+        "calib": CALIB_STATES.get(calib, str(calib)),
+        "reset": "+".join(flags) or "none",
+        "load": load / 10,
+        "stack": stack,
+        "refresh": refresh / 10,
+        "keys": keys,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", help="captured stream or serial device")
+    parser.add_argument("--csv", action="store_true",
+                        help="print CSV rows instead of text lines")
+    args = parser.parse_args()
+
+    if args.csv:
+        print(CSV_HEADER)
+    last = None
+    with open(args.capture, "rb") as stream:
+        for raw in records(stream):
+            record = fields(raw)
+            if args.csv:
+                print("%(sequence)d,%(utc)s,%(uptime)d,%(trim).2f,%(calib)s,"
+                      "%(reset)s,%(load).1f,%(stack)d,%(refresh).1f,"
+                      "%(keys)d" % record)
+            else:
+                if last is not None and (last + 1) & 0xFF != record["sequence"]:
+                    print("  ... %d lost"
+                          % ((record["sequence"] - last - 1) & 0xFF))
+                print("%(sequence)3d  %(utc)s UTC  up %(uptime)ds  "
+                      "trim %(trim)+.2fppm (%(calib)s)  reset %(reset)s  "
+                      "load %(load).1f%%  stack %(stack)dB  "
+                      "refresh %(refresh).1fHz  keys %(keys)d" % record)
+            last = record["sequence"]
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
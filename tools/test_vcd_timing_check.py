@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Self-test of vcd_timing_check.py on the traces in vcd_fixtures/.
+
+    python3 tools/test_vcd_timing_check.py
+
+pass.vcd must pass; each other trace carries one injected fault that must
+be reported, and nothing else. The traces are written by
+vcd_fixtures/make_fixtures.py.
+"""
+
+import os
+import subprocess
+import sys
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CHECKER = os.path.join(HERE, "vcd_timing_check.py")
+FIXTURES = os.path.join(HERE, "vcd_fixtures")
+
+
+def check(name, *options):
+    """Run the checker on a fixture; return its exit status and output."""
+    run = subprocess.run(
+        [sys.executable, CHECKER, "--board", "1"] + list(options) +
+        [os.path.join(FIXTURES, name + ".vcd")],
+        stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+        universal_newlines=True)
+    return run.returncode, run.stdout
+
+
+class VcdTimingCheckTest(unittest.TestCase):
+    def assertViolation(self, name, *expected):
+        status, output = check(name)
+        self.assertEqual(status, 1, output)
+        self.assertIn("%d timing violations:" % len(expected), output)
+        for text in expected:
+            self.assertIn(text, output)
+
+    def test_pass(self):
+        status, output = check("pass")
+        self.assertEqual(status, 0, output)
+        self.assertIn("LCD: 10 EN pulses, narrowest 500ns", output)
+        self.assertIn("display: 4 frames, period 12000-12000us", output)
+        self.assertIn("clock: 2 seconds", output)
+        self.assertIn("all timing checks passed", output)
+
+    def test_en_width(self):
+        self.assertViolation("en_width", "LCD EN high 300ns < 450ns")
+
+    def test_data_setup(self):
+        self.assertViolation("data_setup", "LCD data setup 100ns < 195ns")
+
+    def test_digit_spread(self):
+        self.assertViolation("digit_spread", "digit lit times "
+                             "[1936, 1936, 1936, 1900, 1936, 1936] us differ")
+
+    def test_digit_spread_allow_dim(self):
+        status, output = check("digit_spread", "--allow-dim")
+        self.assertEqual(status, 0, output)
+
+    def test_dark_gap(self):
+        self.assertViolation("dark_gap", "dark gap 20us < 64us")
+
+    def test_second_length(self):
+        self.assertViolation("second_length", "second lasted 1001000us",
+                             "second lasted 999000us")
+
+    def test_fixtures_up_to_date(self):
+        sys.dont_write_bytecode = True
+        sys.path.insert(0, FIXTURES)
+        import make_fixtures
+        for name in make_fixtures.TRACES:
+            with open(os.path.join(FIXTURES, name + ".vcd")) as vcd:
+                self.assertEqual(vcd.read(), make_fixtures.trace(
+                    None if name == "pass" else name), name)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Write the synthetic VCD traces used by tools/test_vcd_timing_check.py.
+
+Each trace is what simavr records for a BOARD_PROFILE 1 build: ten LCD
+nibble writes on PORTA, four seven segment frames on PORTB/PORTC and three
+Timer2 overflows one second apart. pass.vcd meets every limit of
+vcd_timing_check.py; each other file injects one fault, named after it.
+Run it again after a change here and commit the .vcd files.
+"""
+
+import os
+
+US = 1000
+EN, RS = 1, 4  # PA0, PA2
+IDS = {"PORTA": "!", "PORTB": "%", "PORTC": "&", "PORTD": "'",
+       "TIMER2_OVF": "("}
+TRACES = ["pass", "en_width", "data_setup", "digit_spread", "dark_gap",
+          "second_length"]
+NIBBLES = [0x3, 0x3, 0x3, 0x2, 0x2, 0x8, 0x0, 0xC, 0x3, 0x1]
+
+
+def trace(fault=None):
+    """Return the text of one trace, with the named fault injected."""
+    ev = []  # (time_ns, name, value)
+    # LCD: one nibble write per 1.2us, EN high 500ns, data set with RS
+    t = 1000 * US
+    for k, nib in enumerate(NIBBLES):
+        rs = RS if k >= 4 else 0
+        base = rs | nib << 4
+        width = 300 if fault == "en_width" and k == 6 else 500
+        ev.append((t, "PORTA", base))
+        ev.append((t + 100, "PORTA", base | EN))
+        if fault == "data_setup" and k == 7:
+            ev.append((t + 500, "PORTA", (base ^ 0x10) | EN))
+            base ^= 0x10
+        ev.append((t + 100 + width, "PORTA", base))
+        t += 1200
+    # display: 6 digits in a 12ms frame, 1936us lit and 64us dark each
+    t = 5000 * US
+    ev.append((t - 100 * US, "PORTC", 0x3F))
+    for frame in range(4):
+        for d in range(6):
+            start = t + (frame * 6 + d) * 2000 * US
+            lit = 1936 * US
+            if frame == 2 and d == 3:
+                if fault == "digit_spread":
+                    lit = 1900 * US
+                if fault == "dark_gap":
+                    start -= 44 * US
+            ev.append((start - 10 * US, "PORTB", (0x3F + d * 7) & 0xFF))
+            ev.append((start, "PORTC", 0x3F & ~(1 << d)))
+            ev.append((start + lit, "PORTC", 0x3F))
+    ev.append((t + 24 * 2000 * US, "PORTC", 0x3E))  # closes frame 4
+    # clock: a Timer2 overflow ISR every second
+    for s in range(3):
+        tick = (500000 + s * 1000000) * US
+        if fault == "second_length" and s == 1:
+            tick += 1000 * US
+        ev.append((tick, "TIMER2_OVF", 1))
+        ev.append((tick + 20 * US, "TIMER2_OVF", 0))
+
+    out = ["$timescale 1ns $end", "$scope module logic $end"]
+    for name, key in IDS.items():
+        out.append("$var wire %d %s %s $end" %
+                   (1 if name == "TIMER2_OVF" else 8, key, name))
+    out += ["$upscope $end", "$enddefinitions $end", "$dumpvars"]
+    for name, key in IDS.items():
+        out.append(("0%s" if name == "TIMER2_OVF" else "b0 %s") % key)
+    out.append("$end")
+    last = None
+    for time, name, value in sorted(ev):
+        if time != last:
+            out.append("#%d" % time)
+            last = time
+        if name == "TIMER2_OVF":
+            out.append("%d%s" % (value, IDS[name]))
+        else:
+            out.append("b%s %s" % (format(value, "b"), IDS[name]))
+    return "\n".join(out) + "\n"
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    for name in TRACES:
+        with open(os.path.join(here, name + ".vcd"), "w") as vcd:
+            vcd.write(trace(None if name == "pass" else name))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""Check the pin-level timing of the clock in a simavr VCD trace.
+
+Build the firmware with -DSIMAVR_TRACE=1 (RealTimeClock/LIB/simavr_trace.c)
+so the ELF asks simavr to record PORTA-PORTD and the Timer2 overflow ISR,
+run it for a few simulated seconds, then check the trace:
+
+    timeout 20 simavr -m atmega32 -f 8000000 RealTimeClock.elf
+    python3 tools/vcd_timing_check.py --board 1 rtc_trace.vcd
+
+tools/simavr_timing_run.py runs these steps in one go, and
+tools/test_vcd_timing_check.py tests this checker on synthetic traces.
+
+Checked on every board: HD44780 enable pulse width and cycle time, RS/RW
+setup to the enable rise, data setup and hold around the enable fall, and
+one Timer2 overflow (one clock second) per 32768 crystal cycles. Checked
+on seven segment boards: the refresh period, equal lit time of the digits
+of a frame, the dark gap between digits, and no segment change while a
+digit is lit. Exits with status 1 and lists the violations if any fails.
+"""
+
+import argparse
+import sys
+
+# Pins of each BOARD_PROFILE, from RealTimeClock/LIB/board_pinmap.h
+BOARDS = {
+    1: {  # BOARD_PROTEUS_RTC
+        "lcd_ctrl": "PORTA", "en": 0, "rw": 1, "rs": 2,
+        "lcd_data": "PORTA", "data_mask": 0xF0,
+        "seg_data": "PORTB", "digits": "PORTC", "digit_mask": 0x3F,
+    },
+    2: {  # BOARD_LCD_ONLY
+        "lcd_ctrl": "PORTC", "en": 2, "rw": 3, "rs": 4,
+        "lcd_data": "PORTA", "data_mask": 0xFF,
+        "seg_data": None, "digits": None, "digit_mask": 0,
+    },
+    3: {  # BOARD_SPI_DISPLAY: the display sits behind the SPI shift
+        # registers, so only the LCD and the clock are on port pins
+        "lcd_ctrl": "PORTA", "en": 0, "rw": 1, "rs": 2,
+        "lcd_data": "PORTA", "data_mask": 0xF0,
+        "seg_data": None, "digits": None, "digit_mask": 0,
+    },
+}
+
+# HD44780 write/read timing at 5V (datasheet minimums)
+EN_HIGH_MIN_NS = 450     # PWEH
+EN_CYCLE_MIN_NS = 1000   # tcycE
+ADDR_SETUP_NS = 40       # tAS, RS/RW before the EN rise
+DATA_SETUP_NS = 195      # tDSW, data before the EN fall
+DATA_HOLD_NS = 10        # tH, data after the EN fall
+
+# Seven segment refresh, from "seven segment_config.h"
+FRAME_NS = 12000000      # SEVSEG_FRAME_US
+BLANK_MIN_NS = 64000     # SEVSEG_BLANK_US
+TIMER0_COUNT_NS = 8000   # clk/64 at 8MHz
+
+SECOND_NS = 1000000000   # 32768 crystal cycles (Timer2 clk/128, 256 counts)
+
+UNITS = {"s": 10 ** 9, "ms": 10 ** 6, "us": 10 ** 3, "ns": 1, "ps": 10 ** -3}
+
+
+def read_vcd(path, wanted):
+    """Return {name: [(time_ns, value), ...]} for the wanted signals."""
+    ids, changes, scale, time = {}, {}, 1, 0
+    with open(path) as vcd:
+        tokens = iter(vcd.read().split())
+    for token in tokens:
+        if token == "$timescale":
+            text = ""
+            for part in tokens:
+                if part == "$end":
+                    break
+                text += part
+            number = text.rstrip("munps")
+            scale = int(number) * UNITS[text[len(number):]]
+        elif token == "$var":
+            fields = []
+            for part in tokens:
+                if part == "$end":
+                    break
+                fields.append(part)
+            if fields[3] in wanted:
+                ids[fields[2]] = fields[3]
+                changes.setdefault(fields[3], [])
+        elif token.startswith("#"):
+            time = int(int(token[1:]) * scale)
+        elif token[0] in "bB":
+            key = next(tokens)
+            if key in ids:
+                bits = token[1:].replace("x", "0").replace("z", "0")
+                changes[ids[key]].append((time, int(bits, 2)))
+        elif token[0] in "01xz" and token[1:] in ids:
+            value = 1 if token[0] == "1" else 0
+            changes[ids[token[1:]]].append((time, value))
+    return changes
+
+
+def merge(changes, names):
+    """Walk the changes of several signals in time order, giving the time,
+    the value of every signal before and after each instant."""
+    events = sorted((t, n, v) for n in names for t, v in changes.get(n, []))
+    state = {n: 0 for n in names}
+    i = 0
+    while i < len(events):
+        time = events[i][0]
+        before = dict(state)
+        while i < len(events) and events[i][0] == time:
+            state[events[i][1]] = events[i][2]
+            i += 1
+        yield time, before, dict(state)
+
+
+class Report:
+    def __init__(self):
+        self.errors = []
+        self.notes = []
+
+    def fail(self, time, text):
+        if len(self.errors) < 50:
+            self.errors.append("%12.6f ms  %s" % (time / 1e6, text))
+        elif len(self.errors) == 50:
+            self.errors.append("... more violations not listed")
+
+    def note(self, text):
+        self.notes.append(text)
+
+
+def check_lcd(changes, board, report):
+    ctrl, data = board["lcd_ctrl"], board["lcd_data"]
+    en, rw, rs = 1 << board["en"], 1 << board["rw"], 1 << board["rs"]
+    mask = board["data_mask"]
+    if data == ctrl:
+        mask &= ~(en | rw | rs)
+    last_rise = addr_change = data_change = None
+    pulses, narrowest = 0, None
+
+    for time, before, after in merge(changes, {ctrl, data}):
+        if (before[ctrl] ^ after[ctrl]) & (rw | rs):
+            addr_change = time
+            if after[ctrl] & en and before[ctrl] & en:
+                report.fail(time, "LCD RS/RW changed while EN is high")
+        if (before[data] ^ after[data]) & mask:
+            data_change = time
+        rise = not before[ctrl] & en and after[ctrl] & en
+        fall = before[ctrl] & en and not after[ctrl] & en
+        if rise:
+            if last_rise is not None and time - last_rise < EN_CYCLE_MIN_NS:
+                report.fail(time, "LCD EN cycle %dns < %dns" %
+                            (time - last_rise, EN_CYCLE_MIN_NS))
+            if addr_change is not None and time - addr_change < ADDR_SETUP_NS:
+                report.fail(time, "LCD RS/RW setup %dns < %dns" %
+                            (time - addr_change, ADDR_SETUP_NS))
+            last_rise = time
+        if fall and last_rise is not None:
+            width = time - last_rise
+            pulses += 1
+            narrowest = width if narrowest is None else min(narrowest, width)
+            if width < EN_HIGH_MIN_NS:
+                report.fail(time, "LCD EN high %dns < %dns" %
+                            (width, EN_HIGH_MIN_NS))
+            if after[ctrl] & rw or data_change is None:
+                continue  # a read: the display drives the bus
+            if data_change == time:
+                report.fail(time, "LCD data changed with the EN fall "
+                            "(hold %dns)" % DATA_HOLD_NS)
+            elif time - data_change < DATA_SETUP_NS:
+                report.fail(time, "LCD data setup %dns < %dns" %
+                            (time - data_change, DATA_SETUP_NS))
+    if pulses == 0:
+        report.fail(0, "no LCD EN pulse in the trace")
+    else:
+        report.note("LCD: %d EN pulses, narrowest %dns" % (pulses, narrowest))
+
+
+def check_sevseg(changes, board, report, tolerance, allow_dim):
+    segs, digits = board["seg_data"], board["digits"]
+    mask = board["digit_mask"]
+    lit_since = dark_since = frame_start = None
+    frame, periods, spread = [], [], 0
+    started = False
+
+    for time, before, after in merge(changes, {segs, digits}):
+        lit = ~after[digits] & mask  # enables are active low
+        was_lit = ~before[digits] & mask
+        if not started:  # the port reads 0 until the driver set it up
+            started = not lit
+            continue
+        if bin(lit).count("1") > 1:
+            report.fail(time, "two digits lit at once (%02x)" % lit)
+        if (before[segs] != after[segs]) and was_lit and lit:
+            report.fail(time, "segments changed while a digit is lit")
+        if was_lit and lit and lit != was_lit:
+            report.fail(time, "next digit lit with no dark gap")
+        if was_lit and not lit:
+            lit_time = time - lit_since
+            frame.append(lit_time)
+            dark_since = time
+        if lit and lit != was_lit:
+            if dark_since is not None and time - dark_since < \
+                    BLANK_MIN_NS - TIMER0_COUNT_NS:
+                report.fail(time, "dark gap %dus < %dus" %
+                            ((time - dark_since) // 1000, BLANK_MIN_NS // 1000))
+            if lit & 1:  # digit 0 starts a frame
+                if frame_start is not None:
+                    period = time - frame_start
+                    periods.append(period)
+                    if abs(period - FRAME_NS) > FRAME_NS * tolerance:
+                        report.fail(time, "refresh period %dus, not %dus" %
+                                    (period // 1000, FRAME_NS // 1000))
+                    if len(frame) > 1 and not allow_dim:
+                        width = max(frame) - min(frame)
+                        spread = max(spread, width)
+                        if width > 2 * TIMER0_COUNT_NS:
+                            report.fail(time, "digit lit times %s us differ" %
+                                        [t // 1000 for t in frame])
+                frame_start, frame = time, []
+            lit_since = time
+    if not periods:
+        report.fail(0, "no complete display refresh in the trace")
+    else:
+        report.note("display: %d frames, period %d-%dus, lit spread %dus" %
+                    (len(periods), min(periods) // 1000,
+                     max(periods) // 1000, spread // 1000))
+
+
+def check_seconds(changes, report, tolerance_ns):
+    ticks = [t for t, v in changes.get("TIMER2_OVF", []) if v]
+    if len(ticks) < 2:
+        report.fail(0, "fewer than two Timer2 overflows, run longer")
+        return
+    for previous, time in zip(ticks, ticks[1:]):
+        if abs(time - previous - SECOND_NS) > tolerance_ns:
+            report.fail(time, "second lasted %dus" % ((time - previous) // 1000))
+    span = ticks[-1] - ticks[0]
+    seconds = round(span / SECOND_NS)
+    if seconds != len(ticks) - 1 or abs(span - seconds * SECOND_NS) > \
+            tolerance_ns:
+        report.fail(ticks[-1], "%d ticks in %.6fs" % (len(ticks) - 1,
+                                                     span / 1e9))
+    report.note("clock: %d seconds, %.6fs simulated" % (len(ticks) - 1,
+                                                       span / 1e9))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("vcd", help="trace written by simavr")
+    parser.add_argument("--board", type=int, choices=sorted(BOARDS),
+                        default=1, help="BOARD_PROFILE of the build")
+    parser.add_argument("--frame-tolerance", type=float, default=0.02,
+                        help="allowed refresh period error (fraction)")
+    parser.add_argument("--tick-tolerance-us", type=int, default=100,
+                        help="allowed error of one second (ISR latency)")
+    parser.add_argument("--allow-dim", action="store_true",
+                        help="the trace has dimmed digits (adjust mode)")
+    args = parser.parse_args()
+
+    board = BOARDS[args.board]
+    names = [board["lcd_ctrl"], board["lcd_data"], "TIMER2_OVF"]
+    if board["digits"]:
+        names += [board["seg_data"], board["digits"]]
+    changes = read_vcd(args.vcd, names)
+    missing = [n for n in names if n not in changes]
+    if missing:
+        sys.exit("vcd_timing_check: %s not in the trace, build with "
+                 "-DSIMAVR_TRACE=1" % ", ".join(missing))
+
+    report = Report()
+    check_lcd(changes, board, report)
+    if board["digits"]:
+        check_sevseg(changes, board, report, args.frame_tolerance,
+                     args.allow_dim)
+    check_seconds(changes, report, args.tick_tolerance_us * 1000)
+
+    for note in report.notes:
+        print(note)
+    if report.errors:
+        print("%d timing violations:" % len(report.errors))
+        for error in report.errors:
+            print("  " + error)
+        sys.exit(1)
+    print("all timing checks passed")
+
+
+if __name__ == "__main__":
+    main()